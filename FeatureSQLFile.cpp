@@ -46,11 +46,26 @@
 #include <OpenMS/METADATA/DataProcessing.h>
 #include <OpenMS/METADATA/MetaInfoInterface.h>
 #include <OpenMS/METADATA/MetaInfoInterfaceUtils.h>
+#include <OpenMS/METADATA/MetaInfoRegistry.h>
 
 #include <OpenMS/SYSTEM/File.h>
 
 #include <sqlite3.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <numeric>
+#include <sstream>
+#include <unordered_map>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 
 
 using namespace std;
@@ -87,15 +102,15 @@ namespace OpenMS
         break;
       case DataValue::STRING_LIST:
         pSTP.prefix = "_SL_";
-        pSTP.sqltype = "TEXT";
+        pSTP.sqltype = "BLOB";
         break;
       case DataValue::INT_LIST:
         pSTP.prefix = "_IL_";
-        pSTP.sqltype = "TEXT";
+        pSTP.sqltype = "BLOB";
         break;
       case DataValue::DOUBLE_LIST:
         pSTP.prefix = "_DL_";
-        pSTP.sqltype = "TEXT";
+        pSTP.sqltype = "BLOB";
         break;
       case DataValue::EMPTY_VALUE:
         pSTP.prefix = "";
@@ -105,6 +120,17 @@ namespace OpenMS
     return pSTP;
   }
 
+  // storing helper function
+  // prefix and type of the column of a meta key, dictionary encoded strings are stored as integer codes
+  PrefixSQLTypePair columnPrefix_(const DataValue::DataType& dt, bool dictionary)
+  {
+    if (dictionary && dt == DataValue::STRING_VALUE)
+    {
+      return {"_SD_", "INTEGER"};
+    }
+    return enumToPrefix_(dt);
+  }
+
   // name sql table with String parameter
   String createTable_(const String& table_name, const String& table_stmt)
   {
@@ -112,11 +138,360 @@ namespace OpenMS
     return create_table_stmt;
   }
 
+  // column or index name as SQL identifier, meta keys may contain any character
+  String quoteIdentifier_(const String& name)
+  {
+    String quoted = name;
+    quoted.substitute("\"", "\"\"");
+    return "\"" + quoted + "\"";
+  }
+
+  // storing helper function
+  // INSERT statement with one positional parameter per column, to be prepared once per table
+  // columns of fixed_values are set to the same SQL literal in every row
+  String createInsert_(const String& table_name, const vector<String>& elements, const map<String, String>& fixed_values = map<String, String>())
+  {
+    vector<String> columns;
+    for (const String& element : elements)
+    {
+      columns.push_back(quoteIdentifier_(element));
+    }
+    vector<String> placeholders(elements.size(), "?");
+    for (const auto& column2value : fixed_values)
+    {
+      columns.push_back(quoteIdentifier_(column2value.first));
+      placeholders.push_back(column2value.second);
+    }
+    String insert_stmt = "INSERT INTO " + table_name + " (" + ListUtils::concatenate(columns, ",") + ") VALUES (" + ListUtils::concatenate(placeholders, ",") + ");";
+    return insert_stmt;
+  }
+
+  // storing helper
+  // single parameter of a prepared statement, filled by worker threads and bound by the writer
+  struct SQLValue_
+  {
+    enum Type {NULL_TYPE, INT_TYPE, REAL_TYPE, TEXT_TYPE, BLOB_TYPE};
+
+    SQLValue_() = default;
+    explicit SQLValue_(int64_t value) : type(INT_TYPE), int_value(value) {}
+    explicit SQLValue_(double value) : type(REAL_TYPE), real_value(value) {}
+    explicit SQLValue_(const String& value) : type(TEXT_TYPE), text_value(value) {}
+
+    Type type = NULL_TYPE;
+    int64_t int_value = 0;
+    double real_value = 0.0;
+    String text_value; // bytes of TEXT and BLOB values
+  };
+
+  // parameters of one INSERT, in column order
+  typedef vector<SQLValue_> SQLRow_;
+
+  // rows of all feature related tables for one chunk of features
+  struct SQLBatch_
+  {
+    vector<SQLRow_> features;
+    vector<SQLRow_> feature_bboxes;
+    vector<SQLRow_> subordinates;
+    vector<SQLRow_> subordinate_bboxes;
+    vector<SQLRow_> region_index;
+    vector<SQLRow_> sparse_meta;
+  };
+
+  // prepared INSERT statements of the feature related tables (nullptr if table is not present)
+  struct SQLStatements_
+  {
+    sqlite3_stmt* features = nullptr;
+    sqlite3_stmt* feature_bboxes = nullptr;
+    sqlite3_stmt* subordinates = nullptr;
+    sqlite3_stmt* subordinate_bboxes = nullptr;
+    sqlite3_stmt* region_index = nullptr;
+    sqlite3_stmt* dictionary = nullptr;
+    sqlite3_stmt* sparse_meta = nullptr;
+    sqlite3_stmt* sparse_meta_delete = nullptr; // update(): sparse meta values replaced
+    sqlite3_stmt* row_key = nullptr; // update() of multi-run files: row key of a feature ID
+
+    // codes of FEATURES_STRING_DICTIONARY and row positions of the dictionary encoded (_SD_) columns
+    unordered_map<std::string, int64_t> dictionary_codes;
+    vector<Size> feature_dictionary_columns;
+    vector<Size> subordinate_dictionary_columns;
+
+    ~SQLStatements_()
+    {
+      finalize();
+    }
+
+    void finalize()
+    {
+      for (sqlite3_stmt** stmt : {&features, &feature_bboxes, &subordinates, &subordinate_bboxes, &region_index, &dictionary, &sparse_meta, &sparse_meta_delete, &row_key})
+      {
+        sqlite3_finalize(*stmt); // no-op on nullptr
+        *stmt = nullptr;
+      }
+    }
+  };
+
+  // storing helper function
+  // append the lowest n_bytes bytes of value in little-endian order
+  void appendLittleEndian_(String& bytes, uint64_t value, Size n_bytes)
+  {
+    for (Size b = 0; b != n_bytes; ++b)
+    {
+      bytes.push_back(static_cast<char>((value >> (8 * b)) & 0xFF));
+    }
+  }
+
+  // storing helper function
+  // binary list encoding: IntList as int32 and DoubleList as IEEE 754 double, both little-endian,
+  // StringList as little-endian uint32 byte length followed by the bytes of each element
+  SQLValue_ toSQLBlob_(const DataValue& value)
+  {
+    SQLValue_ blob;
+    blob.type = SQLValue_::BLOB_TYPE;
+    String& bytes = blob.text_value;
+    if (value.valueType() == DataValue::INT_LIST)
+    {
+      const IntList il = value.toIntList();
+      bytes.reserve(il.size() * sizeof(int32_t));
+      for (int v : il)
+      {
+        appendLittleEndian_(bytes, static_cast<uint32_t>(v), sizeof(int32_t));
+      }
+    }
+    else if (value.valueType() == DataValue::DOUBLE_LIST)
+    {
+      const DoubleList dl = value.toDoubleList();
+      bytes.reserve(dl.size() * sizeof(double));
+      for (double v : dl)
+      {
+        uint64_t bits;
+        memcpy(&bits, &v, sizeof(double));
+        appendLittleEndian_(bytes, bits, sizeof(double));
+      }
+    }
+    else if (value.valueType() == DataValue::STRING_LIST)
+    {
+      for (const String& v : value.toStringList())
+      {
+        appendLittleEndian_(bytes, static_cast<uint32_t>(v.size()), sizeof(uint32_t));
+        bytes += v;
+      }
+    }
+    return blob;
+  }
+
+  // storing helper function
+  // hull point BLOB: encoding byte (the HullPoints value), little-endian uint32 number of points and the points (RT, MZ):
+  // HULL_POINTS: per coordinate the difference of its IEEE 754 bit pattern to the one of the previous point as
+  // zigzag varint (lossless, nearby points share the high bits); HULL_POINTS_FLOAT32: the first point as doubles,
+  // then per coordinate the float32 difference to the previous decoded point; NULL for HULL_BOUNDINGBOX
+  SQLValue_ toSQLHullPoints_(const ConvexHull2D& hull, FeatureSQLFile::HullPoints encoding)
+  {
+    if (encoding == FeatureSQLFile::HULL_BOUNDINGBOX)
+    {
+      return SQLValue_();
+    }
+    const ConvexHull2D::PointArrayType& points = hull.getHullPoints();
+    SQLValue_ blob;
+    blob.type = SQLValue_::BLOB_TYPE;
+    String& bytes = blob.text_value;
+    bytes.push_back(static_cast<char>(encoding));
+    appendLittleEndian_(bytes, points.size(), sizeof(uint32_t));
+    if (encoding == FeatureSQLFile::HULL_POINTS)
+    {
+      uint64_t previous[2] = {0, 0};
+      for (const ConvexHull2D::PointType& point : points)
+      {
+        for (Size dim = 0; dim != 2; ++dim)
+        {
+          const double value = point[dim];
+          uint64_t bits;
+          memcpy(&bits, &value, sizeof(double));
+          const int64_t delta = static_cast<int64_t>(bits - previous[dim]);
+          uint64_t zigzag = (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63);
+          while (zigzag >= 0x80)
+          {
+            bytes.push_back(static_cast<char>((zigzag & 0x7F) | 0x80));
+            zigzag >>= 7;
+          }
+          bytes.push_back(static_cast<char>(zigzag));
+          previous[dim] = bits;
+        }
+      }
+      return blob;
+    }
+    double previous[2] = {0.0, 0.0};
+    for (Size p = 0; p != points.size(); ++p)
+    {
+      for (Size dim = 0; dim != 2; ++dim)
+      {
+        const double value = points[p][dim];
+        if (p == 0)
+        {
+          uint64_t bits;
+          memcpy(&bits, &value, sizeof(double));
+          appendLittleEndian_(bytes, bits, sizeof(double));
+          previous[dim] = value;
+          continue;
+        }
+        // difference to the decoded previous point, so rounding errors are not carried on
+        const float delta = static_cast<float>(value - previous[dim]);
+        uint32_t bits;
+        memcpy(&bits, &delta, sizeof(float));
+        appendLittleEndian_(bytes, bits, sizeof(float));
+        previous[dim] += delta;
+      }
+    }
+    return blob;
+  }
+
+  // storing helper function
+  // DataValue with its native SQL type: integers as INTEGER, doubles as REAL, strings as TEXT, lists as BLOB, empty as NULL
+  SQLValue_ toSQLValue_(const DataValue& value)
+  {
+    switch (value.valueType())
+    {
+      case DataValue::INT_VALUE:
+        return SQLValue_(static_cast<int64_t>(value));
+      case DataValue::DOUBLE_VALUE:
+        return SQLValue_(static_cast<double>(value));
+      case DataValue::STRING_VALUE:
+        return SQLValue_(value.toString());
+      case DataValue::STRING_LIST:
+      case DataValue::INT_LIST:
+      case DataValue::DOUBLE_LIST:
+        return toSQLBlob_(value);
+      case DataValue::EMPTY_VALUE:
+        break;
+    }
+    return SQLValue_();
+  }
+
+  // storing helper function
+  // throw on a failed sqlite3_bind_* call, e.g. SQLITE_RANGE for a value without parameter
+  void checkBind_(sqlite3* db, int rc)
+  {
+    if (rc != SQLITE_OK)
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Error binding value of prepared SQL statement: " + String(sqlite3_errstr(rc)) + " (" + String(sqlite3_errmsg(db)) + ")");
+    }
+  }
+
+  // storing helper function
+  void bindSQLValue_(sqlite3* db, sqlite3_stmt* stmt, int pos, const SQLValue_& value)
+  {
+    int rc = SQLITE_OK;
+    switch (value.type)
+    {
+      case SQLValue_::INT_TYPE:
+        rc = sqlite3_bind_int64(stmt, pos, value.int_value);
+        break;
+      case SQLValue_::REAL_TYPE:
+        rc = sqlite3_bind_double(stmt, pos, value.real_value);
+        break;
+      case SQLValue_::TEXT_TYPE:
+        // rows outlive the step, no copy by SQLite needed
+        rc = sqlite3_bind_text(stmt, pos, value.text_value.c_str(), static_cast<int>(value.text_value.size()), SQLITE_STATIC);
+        break;
+      case SQLValue_::BLOB_TYPE:
+        rc = sqlite3_bind_blob(stmt, pos, value.text_value.c_str(), static_cast<int>(value.text_value.size()), SQLITE_STATIC);
+        break;
+      case SQLValue_::NULL_TYPE:
+        rc = sqlite3_bind_null(stmt, pos);
+        break;
+    }
+    checkBind_(db, rc);
+  }
+
+  // storing helper function
+  // execute bound statement and reset it (including bindings) for the next row
+  void stepStatement_(sqlite3* db, sqlite3_stmt* stmt)
+  {
+    if (sqlite3_step(stmt) != SQLITE_DONE)
+    {
+      String error = sqlite3_errmsg(db);
+      sqlite3_reset(stmt);
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Error executing prepared SQL statement: " + error);
+    }
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+  }
+
+  // storing helper function
+  // bind and execute rows with the prepared statement of their table
+  void insertRows_(sqlite3* db, sqlite3_stmt* stmt, const vector<SQLRow_>& rows)
+  {
+    for (const SQLRow_& row : rows)
+    {
+      // parameters left unbound would silently be stored as NULL
+      if (static_cast<int>(row.size()) != sqlite3_bind_parameter_count(stmt))
+      {
+        throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Row of " + String(row.size()) + " values for prepared SQL statement with " +
+                                         String(sqlite3_bind_parameter_count(stmt)) + " parameters: " + String(sqlite3_sql(stmt)));
+      }
+      for (Size pos = 0; pos != row.size(); ++pos)
+      {
+        bindSQLValue_(db, stmt, static_cast<int>(pos) + 1, row[pos]);
+      }
+      stepStatement_(db, stmt);
+    }
+  }
+
+  // storing helper function
+  // replace the strings at the dictionary encoded positions of rows by their codes,
+  // strings not coded yet are added to FEATURES_STRING_DICTIONARY
+  void encodeStrings_(sqlite3* db, SQLStatements_& statements, const vector<Size>& positions, vector<SQLRow_>& rows)
+  {
+    for (SQLRow_& row : rows)
+    {
+      for (Size pos : positions)
+      {
+        SQLValue_& value = row[pos];
+        if (value.type == SQLValue_::INT_TYPE || value.type == SQLValue_::REAL_TYPE)
+        {
+          // numbers in a string column, as TEXT affinity would store them
+          value = SQLValue_(value.type == SQLValue_::INT_TYPE ? String(static_cast<long long>(value.int_value)) : String(value.real_value));
+        }
+        if (value.type != SQLValue_::TEXT_TYPE) // NULL, lists are kept as they are
+        {
+          continue;
+        }
+        auto it = statements.dictionary_codes.find(value.text_value);
+        if (it == statements.dictionary_codes.end())
+        {
+          const int64_t code = static_cast<int64_t>(statements.dictionary_codes.size());
+          insertRows_(db, statements.dictionary, vector<SQLRow_>(1, {SQLValue_(code), value}));
+          it = statements.dictionary_codes.emplace(value.text_value, code).first;
+        }
+        value = SQLValue_(it->second);
+      }
+    }
+  }
+
+  // storing helper function
+  void insertBatch_(sqlite3* db, SQLStatements_& statements, SQLBatch_& batch)
+  {
+    encodeStrings_(db, statements, statements.feature_dictionary_columns, batch.features);
+    encodeStrings_(db, statements, statements.subordinate_dictionary_columns, batch.subordinates);
+    insertRows_(db, statements.features, batch.features);
+    insertRows_(db, statements.feature_bboxes, batch.feature_bboxes);
+    insertRows_(db, statements.subordinates, batch.subordinates);
+    insertRows_(db, statements.subordinate_bboxes, batch.subordinate_bboxes);
+    // databases written before the region index was introduced have none
+    if (statements.region_index != nullptr)
+    {
+      insertRows_(db, statements.region_index, batch.region_index);
+    }
+    if (statements.sparse_meta != nullptr)
+    {
+      insertRows_(db, statements.sparse_meta, batch.sparse_meta);
+    }
+  }
+
   // resolve type of DataValue by prefix notation 
   DataValue::DataType getColumnDatatype_(const  String& label)
   { 
     DataValue::DataType type;
-    if (label.hasPrefix("_S_"))
+    if (label.hasPrefix("_S_") || label.hasPrefix("_SD_")) // _SD_: dictionary code
     {
       type = DataValue::STRING_VALUE;
     } 
@@ -152,1765 +527,3447 @@ namespace OpenMS
     return type;
   }
 
-/*
-  // write userparameter to feature
-  void setUserParams(Feature& current_feature, String &column_name, const DataValue::DataType column_type, int i, sqlite3_stmt* stmt)
+  // reading helper function
+  // decode little-endian int32/double list BLOB, on little-endian hosts by copying the bytes as they are
+  template <typename T, typename UIntT>
+  vector<T> fromSQLBlob_(const unsigned char* data, Size n_bytes)
   {
-    if (column_type == DataValue::STRING_VALUE)
-    {
-      column_name = column_name.substr(3);
-      String value;
-      Sql::extractValue<String>(&value, stmt, i);
-      current_feature.setMetaValue(column_name, value); 
-    } 
-    else if (column_type == DataValue::INT_VALUE)
+    static_assert(sizeof(T) == sizeof(UIntT), "element and bit pattern type differ in size");
+    vector<T> list(n_bytes / sizeof(T));
+    if (list.empty())
     {
-      column_name = column_name.substr(3);
-      int value = 0;
-      Sql::extractValue<int>(&value, stmt, i);
-      current_feature.setMetaValue(column_name, value); 
-    } 
-    else if (column_type == DataValue::DOUBLE_VALUE)
+      return list;
+    }
+    const uint16_t probe = 1;
+    if (*reinterpret_cast<const unsigned char*>(&probe) == 1)
     {
-      column_name = column_name.substr(3);
-      double value = 0.0;
-      Sql::extractValue<double>(&value, stmt, i);          
-      current_feature.setMetaValue(column_name, value); 
-    } 
-    else if (column_type == DataValue::STRING_LIST)
-    {
-      column_name = column_name.substr(4);
-      String value; 
-      Sql::extractValue<String>(&value, stmt, i);
-
-      StringList sl;
-      // cut off "[" and "]""
-      value = value.chop(1);
-      value = value.substr(1);
-      value.split(", ", sl);
-      current_feature.setMetaValue(column_name, sl);
-    } 
-    else if (column_type == DataValue::INT_LIST)
-    {
-      column_name = column_name.substr(4);
-      String value; //IntList value;
-      Sql::extractValue<String>(&value, stmt, i); //IntList
-      value = value.chop(1);
-      value = value.substr(1);
-      vector<String> value_list;
-      IntList il = ListUtils::create<int>(value, ',');
-      current_feature.setMetaValue(column_name, il);
-    } 
-    else if (column_type == DataValue::DOUBLE_LIST)
-    {
-      column_name = column_name.substr(4);
-      String value; //DoubleList value;
-      Sql::extractValue<String>(&value, stmt, i); //DoubleList
-      value = value.chop(1);
-      value = value.substr(1);          
-      DoubleList dl = ListUtils::create<double>(value, ',');
-      current_feature.setMetaValue(column_name, dl);
-    } 
-    else if (column_type == DataValue::EMPTY_VALUE)
+      memcpy(list.data(), data, list.size() * sizeof(T));
+      return list;
+    }
+    for (Size k = 0; k != list.size(); ++k)
     {
-      String value;
-      Sql::extractValue<String>(&value, stmt, i);
+      UIntT bits = 0;
+      for (Size b = 0; b != sizeof(T); ++b)
+      {
+        bits |= static_cast<UIntT>(data[k * sizeof(T) + b]) << (8 * b);
+      }
+      memcpy(&list[k], &bits, sizeof(T));
     }
+    return list;
   }
-*/
-
 
-  // probe features in feature_map to determine different table instantiation
-  // test flags of tables for
-  //  features, subordinates, dataprocessing, convexhull bboxes respectively 
-  tuple<bool, bool, bool, bool, bool> getTables_(const FeatureMap& feature_map)
+  // reading helper function
+  // decode StringList BLOB of length-prefixed elements
+  StringList fromSQLStringBlob_(const unsigned char* data, Size n_bytes)
   {
-    bool features_switch_, subordinates_switch_, dataprocessing_switch_, features_bbox_switch_, subordinates_bbox_switch_;
-    features_switch_ = false;
-    features_bbox_switch_ = false;
-    subordinates_switch_ = false;
-    subordinates_bbox_switch_ = false;
-    dataprocessing_switch_ = false;
-
-    if (feature_map.getDataProcessing().size() > 0)
+    StringList sl;
+    Size pos = 0;
+    while (pos + sizeof(uint32_t) <= n_bytes)
     {
-      dataprocessing_switch_ = true;
+      uint32_t length = 0;
+      for (Size b = 0; b != sizeof(uint32_t); ++b)
+      {
+        length |= static_cast<uint32_t>(data[pos + b]) << (8 * b);
+      }
+      pos += sizeof(uint32_t);
+      if (pos + length > n_bytes)
+      {
+        throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Truncated string list BLOB in featureSQL file.");
+      }
+      sl.push_back(String(reinterpret_cast<const char*>(data) + pos, length));
+      pos += length;
     }
+    return sl;
+  }
 
-    for (auto feature : feature_map)
+  // reading helper function
+  // decode hull point BLOB of toSQLHullPoints_
+  ConvexHull2D::PointArrayType fromSQLHullPoints_(const unsigned char* data, Size n_bytes)
+  {
+    auto truncated = []()
     {
-      features_switch_ = true;
-      if (feature.getConvexHulls().size() > 0)
+      return Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Truncated hull point BLOB in featureSQL file.");
+    };
+    auto read_little_endian = [&](Size& pos, Size size)
+    {
+      if (pos + size > n_bytes)
       {
-        features_bbox_switch_ = true;
+        throw truncated();
       }
-      for (Feature sub : feature.getSubordinates())
+      uint64_t value = 0;
+      for (Size b = 0; b != size; ++b)
       {
-        subordinates_switch_ = true;
-        if (sub.getConvexHulls().size() > 0)
+        value |= static_cast<uint64_t>(data[pos + b]) << (8 * b);
+      }
+      pos += size;
+      return value;
+    };
+
+    Size pos = 1;
+    if (n_bytes == 0 || (data[0] != FeatureSQLFile::HULL_POINTS && data[0] != FeatureSQLFile::HULL_POINTS_FLOAT32))
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Unknown hull point encoding in featureSQL file.");
+    }
+    const Size n_points = static_cast<Size>(read_little_endian(pos, sizeof(uint32_t)));
+    if (2 * n_points > n_bytes) // at least one byte per coordinate
+    {
+      throw truncated();
+    }
+    ConvexHull2D::PointArrayType points(n_points);
+    if (data[0] == FeatureSQLFile::HULL_POINTS)
+    {
+      uint64_t previous[2] = {0, 0};
+      for (Size p = 0; p != n_points; ++p)
+      {
+        for (Size dim = 0; dim != 2; ++dim)
         {
-          subordinates_bbox_switch_ = true;
+          uint64_t zigzag = 0;
+          for (Size shift = 0; ; shift += 7)
+          {
+            if (pos == n_bytes || shift > 63)
+            {
+              throw truncated();
+            }
+            const unsigned char byte = data[pos++];
+            zigzag |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0)
+            {
+              break;
+            }
+          }
+          previous[dim] += (zigzag >> 1) ^ (0 - (zigzag & 1)); // undo zigzag, add delta
+          double value;
+          memcpy(&value, &previous[dim], sizeof(double));
+          points[p][dim] = value;
         }
       }
+      return points;
     }
-    return make_tuple(features_switch_, subordinates_switch_, dataprocessing_switch_, features_bbox_switch_, subordinates_bbox_switch_);
-  }
-
-
-  ////////////////////////////////////////////////////////////////////////////////////////////////////
-  //write FeatureMap as SQL database                                                      //
-  ////////////////////////////////////////////////////////////////////////////////////////////////////
-  
-  // fitted snippet of FeatureXMLFile::load
-  void FeatureSQLFile::write(const string& out_fm, const FeatureMap& feature_map) const
-  {
-    String path_="/home/mkf/Development/OpenMS/src/tests/class_tests/openms/data/";
-    String filename_ = path_.append(out_fm);
-    
-    // delete file if present
-    File::remove(filename_);
-
-    //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    //variable declaration                                                          //
-    //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////   
-
-    // declare different table entries
-    // feature_elements contains identification number and measurement fields
-    vector<String> feature_elements_ = {"ID", "RT", "MZ", "Intensity", "Charge", "Quality"};
-    vector<String> feature_elements_types_ = {"INTEGER", "REAL", "REAL", "REAL", "INTEGER", "REAL"};
-    
-    // subordinate features contain an additional SUB_IDX field to handle numeration
-    vector<String> subordinate_elements_ = {"ID", "SUB_IDX" , "REF_ID", "RT", "MZ", "Intensity", "Charge", "Quality"};
-    vector<String> subordinate_elements_types_ = {"INTEGER", "INTEGER", "INTEGER", "REAL", "REAL", "REAL", "INTEGER", "REAL"};
-
-    // metadata entries of dataprocessing
-    vector<String> dataprocessing_elements_ = {"ID", "SOFTWARE", "SOFTWARE_VERSION", "DATA", "TIME", "ACTIONS"};
-    vector<String> dataprocessing_elements_types_ = {"INTEGER" ,"TEXT" ,"TEXT" ,"TEXT" ,"TEXT" , "TEXT"};
-
-    // convex hull parameters by feature
-    vector<String> feat_bounding_box_elements_ = {"REF_ID", "min_MZ", "min_RT", "max_MZ", "max_RT", "BB_IDX"};
-    vector<String> feat_bounding_box_elements_types_ = {"INTEGER" ,"REAL" ,"REAL" ,"REAL" , "REAL", "INTEGER"};
-
-    // convex hull parameters b subordinate
-    vector<String> sub_bounding_box_elements_ = {"ID", "REF_ID", "min_MZ", "min_RT", "max_MZ", "max_RT", "BB_IDX"};
-    vector<String> sub_bounding_box_elements_types_ = {"INTEGER" ,"INTEGER" ,"REAL" ,"REAL" ,"REAL" , "REAL", "INTEGER"};
-
-    // initialize tables
-    auto tables_ = getTables_(feature_map);
-    bool features_switch_ = get<0>(tables_);
-    bool subordinates_switch_ = get<1>(tables_);
-    bool dataprocessing_switch_ = get<2>(tables_);
-    bool features_bbox_switch_ = get<3>(tables_);
-    bool subordinates_bbox_switch_ = get<4>(tables_);
-
-    // read values of (user)parameters of feature_map and store as key value map
-    // include all CommonMetaKeys by setting frequency to 0.0 in the map_key2type_
-    set<String> common_keys_ = MetaInfoInterfaceUtils::findCommonMetaKeys<FeatureMap, set<String> >(feature_map.begin(), feature_map.end(), 0.0);
-    map<String, DataValue::DataType> map_key2type_;
-
-    for (auto feature : feature_map)
+    double previous[2] = {0.0, 0.0};
+    for (Size p = 0; p != n_points; ++p)
     {
-      for (const String& key : common_keys_)
+      for (Size dim = 0; dim != 2; ++dim)
       {
-        if (feature.metaValueExists(key))
+        if (p == 0)
+        {
+          const uint64_t bits = read_little_endian(pos, sizeof(double));
+          memcpy(&previous[dim], &bits, sizeof(double));
+        }
+        else
         {
-          const DataValue::DataType& dt = feature.getMetaValue(key).valueType();
-          map_key2type_[key] = dt;
+          const uint32_t bits = static_cast<uint32_t>(read_little_endian(pos, sizeof(float)));
+          float delta;
+          memcpy(&delta, &bits, sizeof(float));
+          previous[dim] += delta;
         }
+        points[p][dim] = previous[dim];
       }
     }
+    return points;
+  }
 
-    // fill vector with (user)parameters of DataProcessing
-    // map with corresponding datatype in dataproc_map_key2type_
-    // define String vector sequenc_keys, storing succession of userparameters keys in feature_map
-    vector<String> dataproc_keys_;
-    const vector<DataProcessing> dataprocessing_userparams = feature_map.getDataProcessing();
-    map<String, DataValue::DataType> dataproc_map_key2type_;
-    vector<String> sequence_keys_;
-    for (auto dataproc_userparam : dataprocessing_userparams)       // inspect DataProcessing entry 
+  // reading helper
+  // decoding step of one userparam column, resolved once per prepared statement
+  struct ColumnDecoder_
+  {
+    int column;               // result column of the statement
+    UInt key;                 // MetaInfoRegistry index of the meta key
+    DataValue::DataType type; // DataValue type given by the column prefix
+    const vector<DataValue>* dictionary; // values by code of dictionary encoded (_SD_) columns, nullptr otherwise
+  };
+
+  // decoders of all userparam columns of a statement
+  typedef vector<ColumnDecoder_> DecoderPlan_;
+
+  // reading helper function
+  // resolve type prefix and meta key of the result columns [first_column, end_column) once,
+  // columns without type prefix (ID, RT, ...) are not part of the plan
+  // dictionary: values of FEATURES_STRING_DICTIONARY by code, for dictionary encoded columns
+  DecoderPlan_ compileDecoders_(sqlite3_stmt* stmt, int first_column, int end_column, const vector<DataValue>* dictionary = nullptr)
+  {
+    DecoderPlan_ plan;
+    for (int i = first_column; i < end_column; ++i)
     {
-      dataproc_userparam.getKeys(dataproc_keys_);                   // get keys of current dataproc_userparam entry
-      for (auto key : dataproc_keys_)
+      const String column_name = sqlite3_column_name(stmt, i);
+      const DataValue::DataType column_type = getColumnDatatype_(column_name);
+      if (column_type == DataValue::EMPTY_VALUE)
       {
-        const DataValue::DataType& dt = dataproc_userparam.getMetaValue(key).valueType();  // get DataType of current key
-        dataproc_map_key2type_[key] = dt; // save key, datatype pair
-        sequence_keys_.push_back(key); // store sequence of dataprocessing keys for reuse in table generation
+        continue;
       }
+      // key follows the type prefix (_S_, _IL_, ...)
+      const String key = column_name.substr(column_name.find('_', 1) + 1);
+      plan.push_back({i, MetaInfoInterface::metaRegistry().registerName(key), column_type, column_name.hasPrefix("_SD_") ? dictionary : nullptr});
     }
+    return plan;
+  }
 
-    // get number  of user parameters to derive explicit NULL value entries for empty features 
-    int user_param_null_entries_ = common_keys_.size();
-    vector<String> null_entries_(user_param_null_entries_, "NULL");
-    String null_entry_line_ = ListUtils::concatenate(null_entries_, ",");
-
-
-    ////////////////////////////////////////////////////////////////////////////////////////////////////
-    /// build feature header for sql table                                                            //                                      //
-    /// build subordinate header as sql table                                                         //                                      //
-    /// build dataprocessing header as sql table                                                      //                                      //
-    /// build boundingbox header as sql table                                                         //                                      //
-    ////////////////////////////////////////////////////////////////////////////////////////////////////
-        
-    // set feature header with dynamic part of user_parameters and respective entries of feature type
-    for (const String& key : common_keys_)
+  // reading helper function
+  // list in "[a, b]" text rendering of older files
+  DataValue fromSQLTextList_(sqlite3_stmt* stmt, int i, DataValue::DataType type)
+  {
+    String value;
+    Sql::extractValue<String>(&value, stmt, i);
+    // cut off "[" and "]""
+    value = value.chop(1);
+    value = value.substr(1);
+    if (type == DataValue::INT_LIST)
     {
-      // feature_elements_ vector with strings prefix (_TYPE_, _S_, _IL_, ...) and key  
-      feature_elements_.push_back(enumToPrefix_(map_key2type_[key]).prefix + key);
-      // feature_elements_ vector with SQL TYPES 
-      feature_elements_types_.push_back(enumToPrefix_(map_key2type_[key]).sqltype);
+      return DataValue(ListUtils::create<int>(value, ','));
+    }
+    if (type == DataValue::DOUBLE_LIST)
+    {
+      return DataValue(ListUtils::create<double>(value, ','));
     }
+    StringList sl;
+    value.split(", ", sl);
+    return DataValue(sl);
+  }
 
-    // prepare subordinate header
-    map<String, DataValue::DataType> subordinate_key2type_;
-    for (FeatureMap::const_iterator feature_it = feature_map.begin(); feature_it != feature_map.end(); ++feature_it)
-    {
-      for (vector<Feature>::const_iterator subord_it = feature_it->getSubordinates().begin(); subord_it != feature_it->getSubordinates().end(); ++subord_it)
-      { 
-        vector<String> keys;
-        subord_it->getKeys(keys);
-        for (const String& key : keys)
+  // reading helper function
+  // write userparameter of the decoder's column of the current row to meta, NULL values are skipped
+  void decodeUserParam_(MetaInfoInterface& meta, sqlite3_stmt* stmt, const ColumnDecoder_& decoder)
+  {
+    const int i = decoder.column;
+    const int cell_type = sqlite3_column_type(stmt, i);
+    if (cell_type == SQLITE_NULL) // key not set for this entry
+    {
+      return;
+    }
+    switch (decoder.type)
+    {
+      case DataValue::STRING_VALUE:
+        if (decoder.dictionary != nullptr && cell_type == SQLITE_INTEGER)
         {
-          subordinate_key2type_[key] = subord_it->getMetaValue(key).valueType();
+          const int64_t code = sqlite3_column_int64(stmt, i);
+          if (code < 0 || code >= static_cast<int64_t>(decoder.dictionary->size()))
+          {
+            throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Unknown string dictionary code " + String(static_cast<long long>(code)) + " in featureSQL file.");
+          }
+          meta.setMetaValue(decoder.key, (*decoder.dictionary)[code]);
         }
-      }
+        else
+        {
+          meta.setMetaValue(decoder.key, String(reinterpret_cast<const char*>(sqlite3_column_text(stmt, i)), sqlite3_column_bytes(stmt, i)));
+        }
+        break;
+      case DataValue::INT_VALUE:
+        meta.setMetaValue(decoder.key, sqlite3_column_int64(stmt, i));
+        break;
+      case DataValue::DOUBLE_VALUE:
+        meta.setMetaValue(decoder.key, sqlite3_column_double(stmt, i));
+        break;
+      case DataValue::INT_LIST:
+      case DataValue::DOUBLE_LIST:
+      case DataValue::STRING_LIST:
+        if (cell_type == SQLITE_BLOB) // binary list
+        {
+          const unsigned char* data = static_cast<const unsigned char*>(sqlite3_column_blob(stmt, i));
+          const Size n_bytes = sqlite3_column_bytes(stmt, i);
+          if (decoder.type == DataValue::INT_LIST)
+          {
+            meta.setMetaValue(decoder.key, fromSQLBlob_<Int, uint32_t>(data, n_bytes));
+          }
+          else if (decoder.type == DataValue::DOUBLE_LIST)
+          {
+            meta.setMetaValue(decoder.key, fromSQLBlob_<double, uint64_t>(data, n_bytes));
+          }
+          else
+          {
+            meta.setMetaValue(decoder.key, fromSQLStringBlob_(data, n_bytes));
+          }
+        }
+        else
+        {
+          meta.setMetaValue(decoder.key, fromSQLTextList_(stmt, i, decoder.type));
+        }
+        break;
+      case DataValue::EMPTY_VALUE:
+        break;
     }
+  }
 
-    // set subordinate header with dynamic part of user_parameters and respective entries of feature type
-    for (const auto& key2type : subordinate_key2type_)
+  // reading helper function
+  // write userparameters of current row to feature, subordinate or dataprocessing entry, NULL values are skipped
+  void decodeUserParams_(MetaInfoInterface& meta, sqlite3_stmt* stmt, const DecoderPlan_& plan)
+  {
+    for (const ColumnDecoder_& decoder : plan)
     {
-      // subordinate_elements_ vector with strings prefix (_TYPE_, _S_, _IL_, ...) and key  
-      subordinate_elements_.push_back(enumToPrefix_(subordinate_key2type_[key2type.first]).prefix + key2type.first);
-      // subordinate_elements_type vector with SQL TYPES 
-      subordinate_elements_types_.push_back(enumToPrefix_(subordinate_key2type_[key2type.second]).sqltype);
+      decodeUserParam_(meta, stmt, decoder);
     }
+  }
 
 
-    // prepare dataprocessing header
-    for (auto & key : dataproc_keys_)
-    { 
-      // set header entries and types 
-      String dataproc_element = enumToPrefix_(dataproc_map_key2type_[key]).prefix + key;
-      dataprocessing_elements_.push_back(dataproc_element);
-      String dataproc_element_type = enumToPrefix_(dataproc_map_key2type_[key]).sqltype;
-      dataprocessing_elements_types_.push_back(dataproc_element_type);
+  // RT/MZ extent of a feature: union of its convex hull boundingboxes, or its position if it has no hulls
+  // hull points are (RT, MZ), i.e. X is RT and Y is MZ (the *_BOUNDINGBOX tables store X in min_MZ/max_MZ)
+  DBoundingBox<2> featureExtent_(const Feature& feature)
+  {
+    DBoundingBox<2> extent;
+    for (const ConvexHull2D& hull : feature.getConvexHulls())
+    {
+      const DBoundingBox<2> bbox = hull.getBoundingBox();
+      extent.enlarge(bbox.minPosition());
+      extent.enlarge(bbox.maxPosition());
+    }
+    if (feature.getConvexHulls().empty())
+    {
+      extent.enlarge(feature.getPosition());
     }
+    return extent;
+  }
 
+  // storing helper function
+  // FEATURES_TABLE row of a feature: ID (given row key), RT, MZ, Intensity, Charge, Quality and userparams in order of feature_keys
+  SQLRow_ featureRow_(const Feature& feature, const vector<UInt>& feature_keys, int64_t id)
+  {
+    SQLRow_ row = {SQLValue_(id), SQLValue_(feature.getRT()), SQLValue_(feature.getMZ()), SQLValue_(static_cast<double>(feature.getIntensity())),
+                   SQLValue_(static_cast<int64_t>(feature.getCharge())), SQLValue_(static_cast<double>(feature.getOverallQuality()))};
+    for (UInt key : feature_keys)
+    {
+      // missing keys yield DataValue::EMPTY, stored as NULL
+      row.push_back(toSQLValue_(feature.getMetaValue(key)));
+    }
+    return row;
+  }
 
-    // test for illegal entries/keywords in dataprocessing_header
-    // catch delimited identifiers (invalid identifiers change with SQL dialect)
-    const vector<String> bad_sym_ = {"+", "_", "-", "?", "!", "*", "@", "%", "^", "&", "#", "=", "/", "\\", ":", "\"", "\'"};
+  // MetaInfoRegistry index and KEY_ID of the feature meta keys stored in FEATURES_SPARSE_META
+  typedef vector<pair<UInt, int64_t> > SparseKeys_;
 
-    for (size_t idx = 0; idx != dataprocessing_elements_.size(); ++idx)
+  // storing helper function
+  // FEATURES_SPARSE_META rows (REF_ID, KEY_ID, VALUE) of the sparse meta values a feature (stored with row key id) has
+  void addSparseRows_(const Feature& feature, int64_t id, const SparseKeys_& sparse_keys, vector<SQLRow_>& rows)
+  {
+    for (const auto& key : sparse_keys)
     {
-      // test for illegal SQL entries in dataprocessing_elements_, replace on hit
-      for (const String& sym : bad_sym_)
+      const DataValue& value = feature.getMetaValue(key.first);
+      if (!value.isEmpty())
       {
-        if (dataprocessing_elements_[idx].hasSubstring(sym))                        // use String::quote
-        {
-          dataprocessing_elements_[idx] = dataprocessing_elements_[idx].quote();
-          break;                                                                    // prevent multiple quoting
-        }
+        rows.push_back({SQLValue_(id), SQLValue_(key.second), toSQLValue_(value)});
       }
     }
+  }
 
-    // boundingbox is part of convexhull is part of feature and subordinates
-    // points of MZ/RT-min-/maxima saved as quadrupel of doubles per convexhull number
-    // preparation of boundingbox header needs no further implementation of types at the moment
-
+  // storing helper function
+  // convert feature, its convex hulls and subordinates into rows of the respective tables
+  // userparams follow the core columns in order of the given keys, missing keys stay NULL
+  // feature_keys, subordinate_keys: MetaInfoRegistry indices of the userparam columns
+  // sparse_keys: meta keys of features stored in FEATURES_SPARSE_META instead of a column
+  // hull_points: encoding of the points of convex hulls stored with their boundingboxes
+  // row_id: row key of the feature in a multi-run file, its unique ID follows the userparams (FEATURE_ID);
+  // negative: the (masked) unique ID is the row key
+  void addFeatureRows_(const Feature& feature, const vector<UInt>& feature_keys, const vector<UInt>& subordinate_keys, const SparseKeys_& sparse_keys,
+                       FeatureSQLFile::HullPoints hull_points, int64_t row_id, SQLBatch_& batch)
+  {
+    const int64_t feature_id = static_cast<int64_t>(feature.getUniqueId() & ~(1ULL << 63));
+    const int64_t id = row_id < 0 ? feature_id : row_id;
 
-    ////////////////////////////////////////////////////////////////////////////////////////////////////
-    // create database with empty tables                                                //
-    // construct SQL_labels for feature, subordinate, dataprocessing and boundingbox tables
-    ////////////////////////////////////////////////////////////////////////////////////////////////////
-    // create headers of tables by concatenation of elements and SQL types
-    // use single string with delimiter ',' as TABLE header
-    // distinguish first column (feature ID) as primary key
+    // 1. features
+    batch.features.push_back(featureRow_(feature, feature_keys, id));
+    if (row_id >= 0)
+    {
+      batch.features.back().push_back(SQLValue_(feature_id));
+    }
+    addSparseRows_(feature, id, sparse_keys, batch.sparse_meta);
 
-    // 1. features table
-    vector<String> sql_labels_features_ = {};
-    for (size_t idx = 0; idx != feature_elements_.size(); ++idx)
+    // 2. feature boundingboxes
+    for (Size bb_idx = 0; bb_idx < feature.getConvexHulls().size(); ++bb_idx)
     {
-      sql_labels_features_.push_back(feature_elements_[idx] + " " + feature_elements_types_[idx]);
+      const ConvexHull2D& hull = feature.getConvexHulls()[bb_idx];
+      const DBoundingBox<2> bbox = hull.getBoundingBox();
+      batch.feature_bboxes.push_back({SQLValue_(id), SQLValue_(bbox.minX()), SQLValue_(bbox.minY()), SQLValue_(bbox.maxX()), SQLValue_(bbox.maxY()),
+                                      SQLValue_(static_cast<int64_t>(bb_idx)), toSQLHullPoints_(hull, hull_points)});
     }
-    sql_labels_features_[0].append(" PRIMARY KEY");
-    String sql_stmt_features_ = ListUtils::concatenate(sql_labels_features_, ",");
 
-    // 2. subordinates table
-    vector<String> sql_labels_subordinates_ = {};
-    for (size_t idx = 0; idx != subordinate_elements_.size(); ++idx)
+    // 3. subordinates, REF_ID is the row key of the parent feature
+    // additional SUB_IDX preserves order of subordinates
+    for (Size sub_idx = 0; sub_idx < feature.getSubordinates().size(); ++sub_idx)
     {
-      sql_labels_subordinates_.push_back(subordinate_elements_[idx] + " " + subordinate_elements_types_[idx]);
+      const Feature& sub = feature.getSubordinates()[sub_idx];
+      const int64_t sub_id = static_cast<int64_t>(sub.getUniqueId() & ~(1ULL << 63));
+
+      SQLRow_ sub_row = {SQLValue_(sub_id), SQLValue_(static_cast<int64_t>(sub_idx)), SQLValue_(id), SQLValue_(sub.getRT()), SQLValue_(sub.getMZ()),
+                         SQLValue_(static_cast<double>(sub.getIntensity())), SQLValue_(static_cast<int64_t>(sub.getCharge())),
+                         SQLValue_(static_cast<double>(sub.getOverallQuality()))};
+      for (UInt key : subordinate_keys)
+      {
+        sub_row.push_back(toSQLValue_(sub.getMetaValue(key)));
+      }
+      batch.subordinates.push_back(std::move(sub_row));
+
+      // 4. subordinate boundingboxes
+      for (Size bb_idx = 0; bb_idx < sub.getConvexHulls().size(); ++bb_idx)
+      {
+        const ConvexHull2D& hull = sub.getConvexHulls()[bb_idx];
+        const DBoundingBox<2> bbox = hull.getBoundingBox();
+        batch.subordinate_bboxes.push_back({SQLValue_(sub_id), SQLValue_(id), SQLValue_(static_cast<int64_t>(sub_idx)), SQLValue_(bbox.minX()), SQLValue_(bbox.minY()), SQLValue_(bbox.maxX()),
+                                            SQLValue_(bbox.maxY()), SQLValue_(static_cast<int64_t>(bb_idx)), toSQLHullPoints_(hull, hull_points)});
+      }
     }
-    sql_labels_subordinates_[0].append(" PRIMARY KEY");
-    String sql_stmt_subordinates_ = ListUtils::concatenate(sql_labels_subordinates_, ",");
 
-    // 3. dataprocessing table
-    vector<String> sql_labels_dataprocessing_ = {};
-    for (size_t idx = 0; idx != dataprocessing_elements_.size(); ++idx)
-    { 
-      sql_labels_dataprocessing_.push_back(dataprocessing_elements_[idx] + " " + dataprocessing_elements_types_[idx]);
+    // 5. spatial index
+    const DBoundingBox<2> extent = featureExtent_(feature);
+    batch.region_index.push_back({SQLValue_(id), SQLValue_(extent.minX()), SQLValue_(extent.maxX()), SQLValue_(extent.minY()), SQLValue_(extent.maxY())});
+  }
+
+  // probe features in feature_map to determine different table instantiation
+  // test flags of tables for
+  //  features, subordinates, dataprocessing, convexhull bboxes respectively 
+  tuple<bool, bool, bool, bool, bool> getTables_(const FeatureMap& feature_map)
+  {
+    bool features_switch_, subordinates_switch_, dataprocessing_switch_, features_bbox_switch_, subordinates_bbox_switch_;
+    features_switch_ = false;
+    features_bbox_switch_ = false;
+    subordinates_switch_ = false;
+    subordinates_bbox_switch_ = false;
+    dataprocessing_switch_ = false;
+
+    if (feature_map.getDataProcessing().size() > 0)
+    {
+      dataprocessing_switch_ = true;
     }
-    sql_labels_dataprocessing_[0].append(" PRIMARY KEY");
-    String sql_stmt_dataprocessing_ = ListUtils::concatenate(sql_labels_dataprocessing_, ",");
 
-    // 4. boundingbox table
-    // 4.1 features
-    vector<String> sql_labels_boundingbox_ = {};
-    for (size_t idx = 0; idx != feat_bounding_box_elements_.size(); ++idx)
+    for (const Feature& feature : feature_map)
     {
-      sql_labels_boundingbox_.push_back(feat_bounding_box_elements_[idx] + " " + feat_bounding_box_elements_types_[idx]);
+      features_switch_ = true;
+      if (feature.getConvexHulls().size() > 0)
+      {
+        features_bbox_switch_ = true;
+      }
+      for (const Feature& sub : feature.getSubordinates())
+      {
+        subordinates_switch_ = true;
+        if (sub.getConvexHulls().size() > 0)
+        {
+          subordinates_bbox_switch_ = true;
+        }
+      }
     }
-    // no PRIMARY KEY because of executeStatement's UNIQUE constraint for primary keys
-    // add "NOT NULL" to all entries to ensure valid datapoints
-    for_each(sql_labels_boundingbox_.begin(), sql_labels_boundingbox_.end(), [] (String &s) {s.append(" NOT NULL");});
-    // create single string with delimiter ',' as TABLE header template
-    String sql_stmt_feat_boundingbox = ListUtils::concatenate(sql_labels_boundingbox_, ",");
+    return make_tuple(features_switch_, subordinates_switch_, dataprocessing_switch_, features_bbox_switch_, subordinates_bbox_switch_);
+  }
 
 
-    // 4. boundingbox table
-    // 4.2 subordinates
-    sql_labels_boundingbox_ = {};
-    for (size_t idx = 0; idx != sub_bounding_box_elements_.size(); ++idx)
+  // storing helper
+  // transaction which is rolled back on destruction unless committed, e.g. if an exception leaves write()
+  class SQLTransaction_
+  {
+  public:
+    explicit SQLTransaction_(SqliteConnector& conn) :
+      conn_(conn)
     {
-      sql_labels_boundingbox_.push_back(sub_bounding_box_elements_[idx] + " " + sub_bounding_box_elements_types_[idx]);
+      conn_.executeStatement("BEGIN TRANSACTION;");
     }
-    // add PRIMARY KEY to first entry with first column as primary key of parent feature ID
-    sql_labels_boundingbox_[0].append(" PRIMARY KEY");
-    // add "NOT NULL" to all entries
-    for_each(sql_labels_boundingbox_.begin(), sql_labels_boundingbox_.end(), [] (String &s) {s.append(" NOT NULL");});
-    String sql_stmt_sub_boundingbox_ = ListUtils::concatenate(sql_labels_boundingbox_, ",");
 
+    ~SQLTransaction_()
+    {
+      if (!committed_)
+      {
+        // no throwing from the destructor, errors of the rollback are ignored
+        sqlite3_exec(conn_.getDB(), "ROLLBACK TRANSACTION;", nullptr, nullptr, nullptr);
+      }
+    }
 
-    // check for switch and construct empty table statements
-    String features_table_stmt_, subordinates_table_stmt_, dataprocessing_table_stmt_, feature_boundingbox_table_stmt_, subordinate_boundingbox_table_stmt_;
-    // 1. features
-    if (features_switch_)         // create features table
+    void commit()
     {
-      features_table_stmt_ = createTable_("FEATURES_TABLE", sql_stmt_features_);
-    } 
-    else if (features_switch_)    // no features table, exit process
+      conn_.executeStatement("COMMIT TRANSACTION;");
+      committed_ = true;
+    }
+
+  private:
+    SqliteConnector& conn_;
+    bool committed_ = false;
+  };
+
+  // storing helper function
+  // pragmas of write profile, to be executed on the empty database before any table is created
+  void applyWriteProfile_(SqliteConnector& conn, FeatureSQLFile::WriteProfile profile)
+  {
+    switch (profile)
     {
-      cout << "Error receiving values. No features provided" << endl; 
-      exit (EXIT_FAILURE);
-      //features_table_stmt_ = "";
+      case FeatureSQLFile::BULK_LOAD:
+      case FeatureSQLFile::IN_MEMORY:
+        // journal stays in memory (instead of OFF) so a failed write can still be rolled back
+        conn.executeStatement("PRAGMA page_size = 65536;");
+        conn.executeStatement("PRAGMA journal_mode = MEMORY;");
+        conn.executeStatement("PRAGMA synchronous = OFF;");
+        conn.executeStatement("PRAGMA cache_size = -262144;"); // 256 MiB
+        conn.executeStatement("PRAGMA temp_store = MEMORY;");
+        conn.executeStatement("PRAGMA locking_mode = EXCLUSIVE;");
+        break;
+      case FeatureSQLFile::DURABLE:
+        conn.executeStatement("PRAGMA journal_mode = WAL;");
+        conn.executeStatement("PRAGMA synchronous = FULL;");
+        break;
+      case FeatureSQLFile::DEFAULT_PROFILE:
+      case FeatureSQLFile::SIZE_OF_WRITEPROFILE:
+        break;
     }
-    // 2. subordinates
-    if (subordinates_switch_)   // create subordinates table
+  }
+
+  // storing helper
+  // core columns of a feature related table and their SQL types
+  // userparam columns follow the core columns in FEATURES_TABLE and FEATURES_SUBORDINATES
+  struct TableElements_
+  {
+    vector<String> names;
+    vector<String> types;
+  };
+
+  // storing helper function
+  TableElements_ coreElements_(const String& table)
+  {
+    if (table == "FEATURES_TABLE")
     {
-      subordinates_table_stmt_ = createTable_("FEATURES_SUBORDINATES", sql_stmt_subordinates_);
-    } 
-    else if (subordinates_switch_)
+      // identification number and measurement fields
+      return {{"ID", "RT", "MZ", "Intensity", "Charge", "Quality"}, {"INTEGER", "REAL", "REAL", "REAL", "INTEGER", "REAL"}};
+    }
+    if (table == "FEATURES_SUBORDINATES")
     {
-      subordinates_table_stmt_ = "";
+      // subordinate features contain an additional SUB_IDX field to handle numeration
+      return {{"ID", "SUB_IDX" , "REF_ID", "RT", "MZ", "Intensity", "Charge", "Quality"}, {"INTEGER", "INTEGER", "INTEGER", "REAL", "REAL", "REAL", "INTEGER", "REAL"}};
     }
-    // 3. dataprocessing
-    if (dataprocessing_switch_) // create dataprocessing table
+    if (table == "FEATURES_TABLE_BOUNDINGBOX")
     {
-      dataprocessing_table_stmt_ = createTable_("FEATURES_DATAPROCESSING", sql_stmt_dataprocessing_);
-    } 
-    else if (dataprocessing_switch_)  
+      // convex hull parameters by feature, POINTS holds the encoded hull points (NULL if not stored)
+      return {{"REF_ID", "min_MZ", "min_RT", "max_MZ", "max_RT", "BB_IDX", "POINTS"}, {"INTEGER" ,"REAL" ,"REAL" ,"REAL" , "REAL", "INTEGER", "BLOB"}};
+    }
+    // SUBORDINATES_TABLE_BOUNDINGBOX: convex hull parameters by subordinate, which is identified by its SUB_IDX (subordinate IDs need not be unique)
+    return {{"ID", "REF_ID", "SUB_IDX", "min_MZ", "min_RT", "max_MZ", "max_RT", "BB_IDX", "POINTS"}, {"INTEGER" ,"INTEGER" ,"INTEGER" ,"REAL" ,"REAL" ,"REAL" , "REAL", "INTEGER", "BLOB"}};
+  }
+
+  // storing helper function
+  // column definitions of a feature related table for createTable_, single string with delimiter ','
+  String tableDefinition_(const String& table, const vector<String>& elements, const vector<String>& types)
+  {
+    vector<String> sql_labels;
+    for (size_t idx = 0; idx != elements.size(); ++idx)
     {
-      dataprocessing_table_stmt_ = "";
+      sql_labels.push_back(quoteIdentifier_(elements[idx]) + " " + types[idx]);
     }
-    // 4. boundingbox (features & subordinates)
-    // features
-    if (features_bbox_switch_ == true)  // create bounding box table for features
+    if (table == "FEATURES_TABLE")
     {
-      feature_boundingbox_table_stmt_ = createTable_("FEATURES_TABLE_BOUNDINGBOX", sql_stmt_feat_boundingbox);
-    } 
-    else if (features_bbox_switch_ == false)
+      // first column (feature ID) as primary key
+      sql_labels[0].append(" PRIMARY KEY");
+    }
+    else if (table == "FEATURES_TABLE_BOUNDINGBOX" || table == "SUBORDINATES_TABLE_BOUNDINGBOX")
     {
-      feature_boundingbox_table_stmt_ = "";
+      // no PRIMARY KEY, features and subordinates have one row per convex hull; REF_ID (and ID) are indexed after loading
+      // add "NOT NULL" to all entries but the optional hull points to ensure valid datapoints
+      for_each(sql_labels.begin(), sql_labels.end(), [] (String &s) { if (!s.hasPrefix("\"POINTS\" ")) { s.append(" NOT NULL"); } });
     }
-    // subordinates
-    if (subordinates_bbox_switch_)  // create bounding box table for subordinates
+    // FEATURES_SUBORDINATES: no PRIMARY KEY, subordinate IDs are only unique per feature; (REF_ID, SUB_IDX) is indexed after loading
+    return ListUtils::concatenate(sql_labels, ",");
+  }
+
+  // storing helper function
+  // types of the meta keys of all features (or of all of their subordinates)
+  // keys are collected by MetaInfoRegistry index in a single pass and resolved to names once
+  map<String, DataValue::DataType> metaKeyTypes_(const FeatureMap& feature_map, bool subordinates)
+  {
+    map<UInt, DataValue::DataType> index2type;
+    vector<UInt> meta_indices;
+    auto add_keys = [&index2type, &meta_indices](const Feature& feature)
     {
-      subordinate_boundingbox_table_stmt_ = createTable_("SUBORDINATES_TABLE_BOUNDINGBOX", sql_stmt_sub_boundingbox_);
-    } 
-    else if (subordinates_bbox_switch_ == false)
+      feature.getKeys(meta_indices);
+      for (UInt index : meta_indices)
+      {
+        index2type[index] = feature.getMetaValue(index).valueType();
+      }
+    };
+    for (const Feature& feature : feature_map)
     {
-      subordinate_boundingbox_table_stmt_ = "";
+      if (!subordinates)
+      {
+        add_keys(feature);
+        continue;
+      }
+      for (const Feature& subordinate : feature.getSubordinates())
+      {
+        add_keys(subordinate);
+      }
     }
 
-    // contatenate table Strings
-    String create_sql_ = \
-      features_table_stmt_ + \
-      subordinates_table_stmt_ + \
-      dataprocessing_table_stmt_ + \
-      feature_boundingbox_table_stmt_ + \
-      subordinate_boundingbox_table_stmt_ \
-      ;    
-
-    // Open connection to database
-    SqliteConnector conn(filename_);
-    conn.executeStatement(create_sql_);
-
-
-
-    ////////////////////////////////////////////////////////////////////////////////////////////////////
-    // store FeatureMap data in table fields                                                          //
-    // 1. features                                                                                    //                                    
-    // 2. feature boundingboxes                                                                       //                                    
-    // 3. subordinates                                                                                //
-    // 4. subordinate boundingboxes                                                                   //
-    // 5. dataprocessing                                                                              //
-    ////////////////////////////////////////////////////////////////////////////////////////////////////
-    /// 1. insert data of features table
-    const String feature_elements_sql_stmt_ = ListUtils::concatenate(feature_elements_, ","); 
-    const String feat_bbox_elements_sql_stmt_ = ListUtils::concatenate(feat_bounding_box_elements_, ","); 
+    map<String, DataValue::DataType> key2type;
+    for (const auto& i2t : index2type)
+    {
+      key2type[MetaInfoInterface::metaRegistry().getName(i2t.first)] = i2t.second;
+    }
+    return key2type;
+  }
 
-    // 1.
-    if (features_switch_)
-    // TODO Error handling for empty features?
+  // storing helper function
+  // string meta keys of all features (or of all of their subordinates) to store dictionary encoded:
+  // all for DICTIONARY_ALWAYS, for DICTIONARY_AUTO those with at most half as many distinct values as values
+  set<String> dictionaryKeys_(const FeatureMap& feature_map, const map<String, DataValue::DataType>& key2type, bool subordinates,
+                              FeatureSQLFile::DictionaryEncoding encoding)
+  {
+    set<String> dictionary_keys;
+    if (encoding == FeatureSQLFile::DICTIONARY_NEVER)
     {
-      conn.executeStatement("BEGIN TRANSACTION");
-      //sqlite3_exec(db, "BEGIN TRANSACTION;", NULL, NULL, NULL);
-      for (const Feature& feature : feature_map)
+      return dictionary_keys;
+    }
+    // distinct values and number of values by MetaInfoRegistry index
+    map<UInt, pair<set<String>, Size> > index2values;
+    for (const auto& k2t : key2type)
+    {
+      if (k2t.second == DataValue::STRING_VALUE)
       {
-        String line_stmt_features_table;
-        vector<String> line;
-
-        int64_t id = static_cast<int64_t>(feature.getUniqueId() & ~(1ULL << 63));
-        //int64_t id = feature.getUniqueId();
-
-        line.push_back(id);
-        line.push_back(feature.getRT());
-        line.push_back(feature.getMZ());
-        line.push_back(feature.getIntensity());
-        line.push_back(feature.getCharge());
-        line.push_back(feature.getOverallQuality());
-        
-        // catch features without user params
-        if (feature.isMetaEmpty())
+        index2values[MetaInfoInterface::metaRegistry().getIndex(k2t.first)];
+      }
+    }
+    if (encoding == FeatureSQLFile::DICTIONARY_AUTO)
+    {
+      auto count_values = [&index2values](const Feature& feature)
+      {
+        for (auto& i2v : index2values)
         {
-          //cout << "has no userparams" << endl;
-
-          line_stmt_features_table =  "INSERT INTO FEATURES_TABLE (" + feature_elements_sql_stmt_ + ") VALUES (";
-          line_stmt_features_table += ListUtils::concatenate(line, ",");
-          // check if userparameters are empty
-          if (user_param_null_entries_ != 0)
+          const DataValue& value = feature.getMetaValue(i2v.first);
+          if (value.valueType() == DataValue::STRING_VALUE)
           {
-            line_stmt_features_table += ",";
-            line_stmt_features_table += null_entry_line_;
+            i2v.second.first.insert(value.toString());
+            ++i2v.second.second;
           }
-          line_stmt_features_table += ");";
-          //store in features table
-          conn.executeStatement(line_stmt_features_table);
-
-          continue;
         }
-        else if (!feature.isMetaEmpty())
+      };
+      for (const Feature& feature : feature_map)
+      {
+        if (!subordinates)
         {
-          //cout << "has userparams" << endl;
-
-          for (const String& key : common_keys_)
-          {
-            String s = feature.getMetaValue(key);
-
-            if (s.length() == 0)
-            {
-              s = "NULL";
-            }
-
-            if (map_key2type_[key] == DataValue::STRING_VALUE
-              || map_key2type_[key] == DataValue::STRING_LIST)
-            {
-              s = s.substitute("'", "''"); // SQL escape single quote in strings  
-            }
-
-            if (map_key2type_[key] == DataValue::STRING_VALUE
-              || map_key2type_[key] == DataValue::STRING_LIST
-              || map_key2type_[key] == DataValue::INT_LIST
-              || map_key2type_[key] == DataValue::DOUBLE_LIST)
-            {
-              s = "'" + s + "'"; // quote around SQL strings (and list types)
-            }
-            line.push_back(s);
-          }
-          line_stmt_features_table =  "INSERT INTO FEATURES_TABLE (" + feature_elements_sql_stmt_ + ") VALUES (";
-          line_stmt_features_table += ListUtils::concatenate(line, ",");
-          line_stmt_features_table += ");";
-          //store in features table
-          conn.executeStatement(line_stmt_features_table);
-
+          count_values(feature);
           continue;
         }
+        for (const Feature& subordinate : feature.getSubordinates())
+        {
+          count_values(subordinate);
+        }
       }
-      //sqlite3_exec(db, "END TRANSACTION;", NULL, NULL, NULL);
-      conn.executeStatement("END TRANSACTION");
     }
-    /*
-    cout << "\n\n\n\n\n TEST OUTPUT \n\n\n\n" << endl;
-    // 1*. efficient insert version 
-    if (features_switch_)
-    // TODO Error handling for empty features?
+    for (const auto& i2v : index2values)
     {
-      //line_stmt_features_table =  "INSERT INTO FEATURES_TABLE (" + feature_elements_sql_stmt_ + ") VALUES (";
-      // combined feature property lines 
-      String line_stmt_features_table =  "INSERT INTO FEATURES_TABLE VALUES ";
-      vector<String> lines;
-
-      for (const Feature& feature : feature_map)
+      if (encoding == FeatureSQLFile::DICTIONARY_ALWAYS || 2 * i2v.second.first.size() <= i2v.second.second)
       {
-        // current line of feature
-        String current_line = "(";
+        dictionary_keys.insert(MetaInfoInterface::metaRegistry().getName(i2v.first));
+      }
+    }
+    return dictionary_keys;
+  }
 
-        // container  of feature parameters 
-        vector<String> line;
+  // storing helper function
+  // MetaInfoRegistry indices of the keys in order of the userparam columns
+  vector<UInt> metaKeyIndices_(const map<String, DataValue::DataType>& key2type)
+  {
+    vector<UInt> indices;
+    for (const auto& k2t : key2type)
+    {
+      indices.push_back(MetaInfoInterface::metaRegistry().getIndex(k2t.first));
+    }
+    return indices;
+  }
 
-        int64_t id = static_cast<int64_t>(feature.getUniqueId() & ~(1ULL << 63));        //int64_t id = feature.getUniqueId();
+  // helper function
+  // names of all columns of a table
+  vector<String> getColumnNames_(sqlite3* db, const String& table)
+  {
+    sqlite3_stmt* stmt = nullptr;
+    SqliteConnector::prepareStatement(db, &stmt, "SELECT * FROM " + table + " LIMIT 0;");
+    vector<String> names;
+    for (int i = 0; i < sqlite3_column_count(stmt); ++i)
+    {
+      names.push_back(sqlite3_column_name(stmt, i));
+    }
+    sqlite3_finalize(stmt);
+    return names;
+  }
 
-        // push parameters into container 
-        line.push_back(id);
-        line.push_back(feature.getRT());
-        line.push_back(feature.getMZ());
-        line.push_back(feature.getIntensity());
-        line.push_back(feature.getCharge());
-        line.push_back(feature.getOverallQuality());
-        
-        // catch features without user params
-        if (feature.isMetaEmpty())
-        {
-          current_line += ListUtils::concatenate(line, ",");
-          if (user_param_null_entries_ != 0)
-          {
-            current_line += ",";
-            current_line += null_entry_line_;
-          }
-        }
-        else if (!feature.isMetaEmpty())
-        {
-          for (const String& key : common_keys_)
-          {
-            String s = feature.getMetaValue(key);
-
-            if (s.length() == 0)
-            {
-              s = "NULL";
-            }
-            else if (map_key2type_[key] == DataValue::STRING_VALUE 
-                  || map_key2type_[key] == DataValue::STRING_LIST)
-            {
-              s = s.substitute("'", "''"); // SQL escape single quote in strings  
-            }
-            else if (map_key2type_[key] == DataValue::STRING_VALUE
-                  || map_key2type_[key] == DataValue::STRING_LIST
-                  || map_key2type_[key] == DataValue::INT_LIST
-                  || map_key2type_[key] == DataValue::DOUBLE_LIST)
-            {
-              s = "'" + s + "'"; // quote around SQL strings (and list types)
-            }
-            line.push_back(s);
-          }
-          current_line += ListUtils::concatenate(line, ",");
-          cout << "In here" << endl;
-        }
-        current_line += ")";
-        lines.push_back(current_line);
+  // storing helper function
+  // userparam columns of an existing table for key2type, columns of new keys are added to the table
+  // (dictionary encoded for the strings of dictionary_keys); returns column names in the order of key2type
+  vector<String> addMetaColumns_(SqliteConnector& conn, const String& table, const map<String, DataValue::DataType>& key2type,
+                                 const set<String>& dictionary_keys = set<String>())
+  {
+    // stored userparam columns by key
+    map<String, String> key2column;
+    for (const String& name : getColumnNames_(conn.getDB(), table))
+    {
+      if (getColumnDatatype_(name) != DataValue::EMPTY_VALUE)
+      {
+        key2column[name.substr(name.find('_', 1) + 1)] = name;
       }
+    }
 
-      // check lines size to fit postfix
-      if (lines.size() >= 2)
+    vector<String> columns;
+    for (const auto& k2t : key2type)
+    {
+      auto it = key2column.find(k2t.first);
+      if (it == key2column.end())
       {
-        cout << ListUtils::concatenate(lines, ",") << endl;
-        line_stmt_features_table += ListUtils::concatenate(lines, ",");
-        cout << "\n\n\n\n " << endl;
-        cout << line_stmt_features_table << endl;
-      } 
-      else if (lines.size() < 2)
+        const PrefixSQLTypePair pSTP = columnPrefix_(k2t.second, dictionary_keys.count(k2t.first) != 0);
+        conn.executeStatement("ALTER TABLE " + table + " ADD COLUMN " + quoteIdentifier_(pSTP.prefix + k2t.first) + " " + pSTP.sqltype + ";");
+        columns.push_back(pSTP.prefix + k2t.first);
+      }
+      else if (getColumnDatatype_(it->second) != k2t.second) // a stored string column is used whether it is dictionary encoded or not
       {
-        line_stmt_features_table += lines[0];
+        throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+          "Meta value '" + k2t.first + "' is stored as column '" + it->second + "' of " + table + ", cannot store it as '" + enumToPrefix_(k2t.second).prefix + k2t.first + "'.");
+      }
+      else
+      {
+        columns.push_back(it->second);
       }
-      line_stmt_features_table += ";";
-
-      cout << line_stmt_features_table << endl;
-
-      // output: INSERT INTO features_table VALUES (),(),..,();   // dataset
-      conn.executeStatement(line_stmt_features_table);
-      //sqlite3_exec(db, "END TRANSACTION;", NULL, NULL, NULL);
-
     }
-  */
+    return columns;
+  }
 
-    // 2.
-    if (features_bbox_switch_)
+  // storing helper function
+  // core columns of an existing table followed by the userparam columns of key2type (added if missing)
+  vector<String> tableElements_(SqliteConnector& conn, const String& table, const map<String, DataValue::DataType>& key2type,
+                                const set<String>& dictionary_keys = set<String>())
+  {
+    vector<String> elements = coreElements_(table).names;
+    for (const String& column : addMetaColumns_(conn, table, key2type, dictionary_keys))
     {
-      conn.executeStatement("BEGIN TRANSACTION");
-
-      double min_MZ;
-      double min_RT;
-      double max_MZ;
-      double max_RT;
+      elements.push_back(column);
+    }
+    return elements;
+  }
 
-      // fetch convexhull of feature for bounding box data
-      for (const Feature& feature : feature_map)
+  // storing helper function
+  // keys of key2type set on fewer than the fraction min_frequency of the features, stored in FEATURES_SPARSE_META
+  set<String> rareMetaKeys_(const FeatureMap& feature_map, const map<String, DataValue::DataType>& key2type, double min_frequency)
+  {
+    set<String> rare_keys;
+    if (min_frequency <= 0.0 || feature_map.empty())
+    {
+      return rare_keys;
+    }
+    map<UInt, Size> index2count;
+    vector<UInt> meta_indices;
+    for (const Feature& feature : feature_map)
+    {
+      feature.getKeys(meta_indices);
+      for (UInt index : meta_indices)
       {
-        /// insert boundingbox data to table FEATURES_TABLE_BOUNDINGBOX
-        vector<String> feat_bbox_line;
-
-        int bbox_idx = 0;
-
-        int64_t id = static_cast<int64_t>(feature.getUniqueId() & ~(1ULL << 63));
-        //int64_t id = feature.getUniqueId();
-
-        // add bbox entries of current convexhull until all cvhulls are visited
-        for (Size b_size_ = 0; b_size_ < feature.getConvexHulls().size(); ++b_size_)
-        {
-          //clear vector line for current bbox
-          feat_bbox_line.clear();
-          String line_stmt_features_table_boundingbox_ =  "INSERT INTO FEATURES_TABLE_BOUNDINGBOX (" + feat_bbox_elements_sql_stmt_ + ") VALUES (";
-          bbox_idx = b_size_;
-
-          min_MZ = feature.getConvexHulls()[b_size_].getBoundingBox().minX();
-          min_RT = feature.getConvexHulls()[b_size_].getBoundingBox().minY();
-          max_MZ = feature.getConvexHulls()[b_size_].getBoundingBox().maxX();
-          max_RT = feature.getConvexHulls()[b_size_].getBoundingBox().maxY();
-
-          //cout << "All boundingbox value for all current feature" << b_size_  << min_MZ << "\t" << min_RT << "\t" << max_MZ << "\t" << max_RT << endl;
-
-          feat_bbox_line.push_back(id);
-          feat_bbox_line.insert(feat_bbox_line.end(), {min_MZ,min_RT,max_MZ,max_RT});
-          feat_bbox_line.push_back(bbox_idx);
-
-          line_stmt_features_table_boundingbox_ += ListUtils::concatenate(feat_bbox_line, ",");
-          //store String in FEATURES_TABLE_BOUNDINGBOX
-          line_stmt_features_table_boundingbox_ += ");";
-          conn.executeStatement(line_stmt_features_table_boundingbox_);
-        }
+        ++index2count[index];
       }
-      conn.executeStatement("END TRANSACTION");
     }
-
-    // 3.
-    if (subordinates_switch_)
+    for (const auto& k2t : key2type)
     {
-      conn.executeStatement("BEGIN TRANSACTION");
-
-      /// 2. insert data of subordinates table
-      String line_stmt_;
-      const String subordinate_elements_sql_stmt = ListUtils::concatenate(subordinate_elements_, ","); 
-      //for (auto feature : feature_map)
-      for (const Feature& feature : feature_map)
+      if (index2count[MetaInfoInterface::metaRegistry().getIndex(k2t.first)] < min_frequency * feature_map.size())
       {
-        int sub_idx = 0;
-        vector<String> line;
-        for (const Feature& sub : feature.getSubordinates())
-        {       
-
-          line.push_back(static_cast<int64_t>(sub.getUniqueId() & ~(1ULL << 63)));
-          //int64_t id = sub.getUniqueId();
-          //line.push_back(id);
-
-          // additional index value to preserve order of subordinates
-          line.push_back(sub_idx);
-          ++sub_idx;
-
-          //line.push_back(static_cast<int64_t>(feature.getUniqueId() & ~(1ULL << 63)));
-          line.push_back(feature.getUniqueId());
-
-
-          line.push_back(sub.getRT());
-          line.push_back(sub.getMZ());
-          line.push_back(sub.getIntensity());
-          line.push_back(sub.getCharge());
-          line.push_back(sub.getOverallQuality());
-          for (const pair<String, DataValue::DataType> k2t : subordinate_key2type_)
-          {
-            const String& key = k2t.first;
-            if (sub.metaValueExists(key))
-            {
-              String s = sub.getMetaValue(k2t.first);
-              if (k2t.second == DataValue::STRING_VALUE
-              || k2t.second == DataValue::STRING_LIST)
-              {
-                s = s.substitute("'", "''"); // SQL escape single quote in strings  
-              }
-
-              if (k2t.second == DataValue::STRING_VALUE
-              || k2t.second == DataValue::STRING_LIST
-              || k2t.second == DataValue::INT_LIST
-              || k2t.second == DataValue::DOUBLE_LIST)
-              {
-                s = "'" + s + "'"; // quote around SQL strings (and list types)
-              }
-              line.push_back(s);
-            }
-          }
-          line_stmt_ =  "INSERT INTO FEATURES_SUBORDINATES (" + subordinate_elements_sql_stmt + ") VALUES (";
-          line_stmt_ += ListUtils::concatenate(line, ",");
-          line_stmt_ += ");";
-          //store in subordinates table
-          conn.executeStatement(line_stmt_);
-          //clear vector line
-          line.clear();
-        }
+        rare_keys.insert(k2t.first);
       }
-
-      conn.executeStatement("END TRANSACTION");
     }
+    return rare_keys;
+  }
 
-    // 4.
-    if (subordinates_bbox_switch_)
+  // storing helper function
+  // remove keys from key2type, returns the removed entries
+  map<String, DataValue::DataType> extractMetaKeys_(map<String, DataValue::DataType>& key2type, const set<String>& keys)
+  {
+    map<String, DataValue::DataType> extracted;
+    for (const String& key : keys)
     {
-      conn.executeStatement("BEGIN TRANSACTION");
-
-
-      // fetch bounding box data of subordinate convexhull
-      const String sub_bbox_elements_sql_stmt = ListUtils::concatenate(sub_bounding_box_elements_, ","); 
-      for (const Feature& feature : feature_map)
+      auto it = key2type.find(key);
+      if (it != key2type.end())
       {
-        int64_t ref_id = static_cast<int64_t>(feature.getUniqueId() & ~(1ULL << 63));
-        //int64_t ref_id = feature.getUniqueId();
-
-
-        for (const Feature& sub : feature.getSubordinates())
-        {
-          int64_t id = static_cast<int64_t>(sub.getUniqueId() & ~(1ULL << 63));
-          //int64_t id = sub.getUniqueId();
-
-          /// insert boundingbox data to table SUBORDINATES_TABLE_BOUNDINGBOX
-          vector<String> bbox_line;
-
-          double min_MZ;
-          double min_RT;
-          double max_MZ;
-          double max_RT;
-
-          int bbox_idx = 0;
-
-          // add bbox entries of current convexhull
-          for (Size b_size_ = 0; b_size_ < sub.getConvexHulls().size(); ++b_size_)
-          {
-            //clear vector line for current bbox
-            bbox_line.clear();
-            String line_stmt_subordinates_table_boundingbox =  "INSERT INTO SUBORDINATES_TABLE_BOUNDINGBOX (" + sub_bbox_elements_sql_stmt + ") VALUES (";
-            bbox_idx = b_size_;
-
-            min_MZ = sub.getConvexHulls()[b_size_].getBoundingBox().minX();
-            min_RT = sub.getConvexHulls()[b_size_].getBoundingBox().minY();
-            max_MZ = sub.getConvexHulls()[b_size_].getBoundingBox().maxX();
-            max_RT = sub.getConvexHulls()[b_size_].getBoundingBox().maxY();
-
-            bbox_line.push_back(id);
-            bbox_line.push_back(ref_id);
-            bbox_line.insert(bbox_line.end(), {min_MZ,min_RT,max_MZ,max_RT});
-            bbox_line.push_back(bbox_idx);
-
-            line_stmt_subordinates_table_boundingbox += ListUtils::concatenate(bbox_line, ",");
-            line_stmt_subordinates_table_boundingbox += ");";
-            conn.executeStatement(line_stmt_subordinates_table_boundingbox);
-          }
-        }
+        extracted.insert(*it);
+        key2type.erase(it);
       }
-      conn.executeStatement("END TRANSACTION");
     }
+    return extracted;
+  }
 
-    // 5.
-    if (dataprocessing_switch_)
+  // helper function
+  // KEY_ID and type of the meta keys of features stored in FEATURES_SPARSE_META, empty if the file has none
+  map<String, pair<int64_t, DataValue::DataType> > storedSparseKeys_(sqlite3* db)
+  {
+    map<String, pair<int64_t, DataValue::DataType> > sparse_keys;
+    if (!SqliteConnector::tableExists(db, "FEATURES_SPARSE_KEYS"))
+    {
+      return sparse_keys;
+    }
+    sqlite3_stmt* stmt = nullptr;
+    SqliteConnector::prepareStatement(db, &stmt, "SELECT KEY_ID, META_KEY, VALUE_TYPE FROM FEATURES_SPARSE_KEYS;");
+    while (sqlite3_step(stmt) == SQLITE_ROW)
     {
-      conn.executeStatement("BEGIN TRANSACTION");
+      sparse_keys[reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1))] =
+        make_pair(sqlite3_column_int64(stmt, 0), static_cast<DataValue::DataType>(sqlite3_column_int(stmt, 2)));
+    }
+    sqlite3_finalize(stmt);
+    return sparse_keys;
+  }
 
-      /// 3. insert labels of sql_stmt (INSERT INTO FEATURE_DATAPROCESSING (...))
-      const String dataprocessing_elements_sql_stmt = ListUtils::concatenate(dataprocessing_elements_, ",");
+  // helper function
+  // meta keys of features stored in FEATURES_SPARSE_META
+  set<String> sparseKeyNames_(sqlite3* db)
+  {
+    set<String> names;
+    for (const auto& sparse_key : storedSparseKeys_(db))
+    {
+      names.insert(sparse_key.first);
+    }
+    return names;
+  }
 
-      vector<String> dataproc_elems = {};
-      
-      //DEBUG
-      // get feature_map ID
-      //size_t dp_id = feature_map.getUniqueId();
-      //cout << "\n" << "This is correct dp_id ? " <<  dp_id << endl;
-      //size_t dp_id63 = static_cast<size_t>(feature_map.getUniqueId() & ~(1ULL << 63));
-      //cout << "\n" << "This is correct dp_id63 ? " <<  dp_id63 << endl;
-    
-      // add featureMap object ID to dataproc_elems as database primary key
-      dataproc_elems.push_back(static_cast<int64_t>(feature_map.getUniqueId() & ~(1ULL << 63)));
-      
-      // dataprocessing vector with meta information about experimental setup and meta-information of measurement
-     
-      //const vector<DataProcessing> dataprocessing = feature_map.getDataProcessing();
-      vector<DataProcessing> dataprocessing = feature_map.getDataProcessing();
-    
-    
-      for (auto dataproc_userparam : dataprocessing)
+  // storing helper function
+  // register the keys of key2type as sparse meta keys of features, the (REF_ID, KEY_ID, VALUE) side table
+  // and its key catalog are created on first use; returns the keys in order of key2type
+  SparseKeys_ addSparseKeys_(SqliteConnector& conn, const map<String, DataValue::DataType>& key2type)
+  {
+    SparseKeys_ sparse_keys;
+    if (key2type.empty())
+    {
+      return sparse_keys;
+    }
+    sqlite3* db = conn.getDB();
+    if (!SqliteConnector::tableExists(db, "FEATURES_SPARSE_KEYS"))
+    {
+      conn.executeStatement("CREATE TABLE FEATURES_SPARSE_KEYS (KEY_ID INTEGER PRIMARY KEY, META_KEY TEXT NOT NULL UNIQUE, VALUE_TYPE INTEGER NOT NULL);");
+      // values keep the storage class of their type, the type of the key is given by the catalog
+      conn.executeStatement("CREATE TABLE FEATURES_SPARSE_META (REF_ID INTEGER NOT NULL, KEY_ID INTEGER NOT NULL, VALUE);");
+    }
+    const map<String, pair<int64_t, DataValue::DataType> > stored = storedSparseKeys_(db);
+    vector<SQLRow_> new_keys;
+    for (const auto& k2t : key2type)
+    {
+      auto it = stored.find(k2t.first);
+      int64_t key_id = static_cast<int64_t>(stored.size() + new_keys.size());
+      if (it != stored.end())
       {
- 
-        // add default values of dataprocessing entry
-        dataproc_elems.push_back(dataproc_userparam.getSoftware().getName());
-        dataproc_elems.push_back(dataproc_userparam.getSoftware().getVersion());
-        dataproc_elems.push_back(dataproc_userparam.getCompletionTime().getDate());
-        dataproc_elems.push_back(dataproc_userparam.getCompletionTime().getTime());
-
-        cout << "###########################################################################" << endl;
-        cout << "#######################  Dataprocessing write #############################" << endl;
-        cout << "###########################################################################" << endl;
-
-
-        // get processingAction entries
-        //const set<DataProcessing::ProcessingAction>& proc_ac = dataproc_userparam.getProcessingActions();
-        const set<DataProcessing::ProcessingAction>& proc_ac = dataproc_userparam.getProcessingActions();
-        
-        //vector<String> processing_actions;
-        vector<String> processing_actions;
-        
-        for (const DataProcessing::ProcessingAction& a : proc_ac)
-        {
-          cout << "Process Action Enum is: " << a << endl;
-
-          int enum_proc = a;
-          cout << "Process Action to Int is: " << enum_proc << endl;
-          
-          String action = DataProcessing::NamesOfProcessingAction[a];
-
-          cout << "Process action enum label is: " << action << endl;
-
-          processing_actions.push_back((String) a);
-          //processing_actions.push_back(action);
-          //cout << typeid(a).name()  << endl;
-        }
-
-        cout << processing_actions.size() << endl;
-        cout << ListUtils::concatenate(processing_actions, ",")  << endl;
-
-        if (processing_actions.size() > 1)
+        if (it->second.second != k2t.second)
         {
-          dataproc_elems.push_back(ListUtils::concatenate(processing_actions, ","));
-        } else
-        {
-          dataproc_elems.push_back(processing_actions[0]);
+          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+            "Meta value '" + k2t.first + "' is stored with a different type in FEATURES_SPARSE_META.");
         }
+        key_id = it->second.first;
+      }
+      else
+      {
+        new_keys.push_back({SQLValue_(key_id), SQLValue_(k2t.first), SQLValue_(static_cast<int64_t>(k2t.second))});
+      }
+      sparse_keys.push_back(make_pair(MetaInfoInterface::metaRegistry().getIndex(k2t.first), key_id));
+    }
+    sqlite3_stmt* stmt = nullptr;
+    SqliteConnector::prepareStatement(db, &stmt, "INSERT INTO FEATURES_SPARSE_KEYS (KEY_ID, META_KEY, VALUE_TYPE) VALUES (?,?,?);");
+    insertRows_(db, stmt, new_keys);
+    sqlite3_finalize(stmt);
+    return sparse_keys;
+  }
 
-        conn.executeStatement("END TRANSACTION");
+  // storing helper function
+  // spatial index with one entry per feature spanning all of its convex hulls, used by readRegion
+  // R*Tree if available in the SQLite build, plain table with the same columns otherwise
+  void createRegionIndex_(SqliteConnector& conn)
+  {
+    if (sqlite3_compileoption_used("ENABLE_RTREE"))
+    {
+      conn.executeStatement("CREATE VIRTUAL TABLE FEATURES_REGION_INDEX USING rtree(ID, min_RT, max_RT, min_MZ, max_MZ);");
+    }
+    else
+    {
+      conn.executeStatement("CREATE TABLE FEATURES_REGION_INDEX (ID INTEGER PRIMARY KEY, min_RT REAL, max_RT REAL, min_MZ REAL, max_MZ REAL);");
+    }
+  }
 
-      /*
-        vector<String> proc_act_test;
-        for (int i = 0; i < 19; ++i)
+  // storing helper function
+  // create the features table (with region index) and the requested dependent tables unless present
+  void createMissingTables_(SqliteConnector& conn, bool subordinates, bool features_bbox, bool subordinates_bbox)
+  {
+    const vector<pair<String, bool> > required_tables = {{"FEATURES_TABLE", true}, {"FEATURES_SUBORDINATES", subordinates},
+                                                         {"FEATURES_TABLE_BOUNDINGBOX", features_bbox},
+                                                         {"SUBORDINATES_TABLE_BOUNDINGBOX", subordinates_bbox}};
+    for (const auto& table : required_tables)
+    {
+      if (table.second && !SqliteConnector::tableExists(conn.getDB(), table.first))
+      {
+        const TableElements_ core = coreElements_(table.first);
+        conn.executeStatement(createTable_(table.first, tableDefinition_(table.first, core.names, core.types)));
+        if (table.first == "FEATURES_TABLE")
         {
-          cout << "Process Action Enum number is: " << i << endl;
-          String action = DataProcessing::NamesOfProcessingAction[i];
-          cout << "Process action enum label is: " << action << endl;
-          processing_actions.push_back(action);
+          createRegionIndex_(conn);
         }
-        cout << "Test output of first 10 enums " << ListUtils::concatenate(processing_actions, ",") << endl;
-        cout << "Test output end" << endl;
-      */
       }
-    
-      
-      // userparam entries
-      for (auto dataproc_userparam : dataprocessing_userparams)
+      else if (table.second && table.first.hasSuffix("_BOUNDINGBOX") && !SqliteConnector::columnExists(conn.getDB(), table.first, "POINTS"))
       {
-        dataproc_userparam.getKeys(dataproc_keys_);
-        for (auto& key : dataproc_keys_)
-        {
-          //cout << "key : " << key << "\t with value " << dataproc_userparam.getMetaValue(key) << endl;
-          dataproc_elems.push_back(dataproc_userparam.getMetaValue(key));
-        }
+        // written before hull points could be stored
+        conn.executeStatement("ALTER TABLE " + table.first + " ADD COLUMN POINTS BLOB;");
       }
-
-      // non-userparam entries
-      // resolve SQL type from dataprocessing_elements_types_
-      for (size_t idx = 0; idx != dataprocessing_elements_.size(); ++idx)
+      if (table.second && table.first == "SUBORDINATES_TABLE_BOUNDINGBOX" && !SqliteConnector::columnExists(conn.getDB(), table.first, "SUB_IDX"))
       {
-        if (dataprocessing_elements_types_[idx] == "TEXT")
-        {
-          dataproc_elems[idx] = "'" + dataproc_elems[idx] + "'"; 
-        }
+        // written before hulls were assigned by subordinate position, stored rows keep NULL and are assigned by subordinate ID
+        conn.executeStatement("ALTER TABLE " + table.first + " ADD COLUMN SUB_IDX INTEGER;");
       }
-      String line_stmt_ =  "INSERT INTO FEATURES_DATAPROCESSING (" + dataprocessing_elements_sql_stmt + ") VALUES (";
-      line_stmt_ += ListUtils::concatenate(dataproc_elems, ",");
-      line_stmt_ += ");";
-
-      //store in dataprocessing table
-      conn.executeStatement(line_stmt_);
-    }  
-  } // end of FeatureSQLFile::write
-
-
-
-
+    }
+  }
 
+  // storing helper function
+  // indices used by the readers, built once after loading instead of being updated with every row
+  void createIndices_(SqliteConnector& conn, bool features_bbox, bool subordinates, bool subordinates_bbox)
+  {
+    if (features_bbox)
+    {
+      conn.executeStatement("CREATE INDEX IF NOT EXISTS FEATURES_TABLE_BOUNDINGBOX_REF_ID ON FEATURES_TABLE_BOUNDINGBOX (REF_ID, BB_IDX);");
+    }
+    if (subordinates)
+    {
+      conn.executeStatement("CREATE INDEX IF NOT EXISTS FEATURES_SUBORDINATES_REF_ID ON FEATURES_SUBORDINATES (REF_ID, SUB_IDX);");
+    }
+    if (subordinates_bbox)
+    {
+      conn.executeStatement("CREATE INDEX IF NOT EXISTS SUBORDINATES_TABLE_BOUNDINGBOX_REF_ID ON SUBORDINATES_TABLE_BOUNDINGBOX (REF_ID, SUB_IDX, BB_IDX);");
+    }
+    if (SqliteConnector::tableExists(conn.getDB(), "FEATURES_SPARSE_META"))
+    {
+      conn.executeStatement("CREATE INDEX IF NOT EXISTS FEATURES_SPARSE_META_REF_ID ON FEATURES_SPARSE_META (REF_ID, KEY_ID);");
+    }
+    if (SqliteConnector::tableExists(conn.getDB(), "FEATURES_TABLE"))
+    {
+      // sorted m/z index of searchMZ(), covering the fields of its hits (the unique ID is FEATURE_ID in multi-run files)
+      const String id_column = SqliteConnector::columnExists(conn.getDB(), "FEATURES_TABLE", "FEATURE_ID") ? ", FEATURE_ID" : "";
+      conn.executeStatement("CREATE INDEX IF NOT EXISTS FEATURES_TABLE_MZ ON FEATURES_TABLE (MZ, Charge, RT, Intensity" + id_column + ");");
+    }
+    if (SqliteConnector::tableExists(conn.getDB(), "FEATURES_RUNS"))
+    {
+      // (feature ID, run) key of multi-run files, also used to look up the row keys of feature IDs
+      conn.executeStatement("CREATE UNIQUE INDEX IF NOT EXISTS FEATURES_TABLE_FEATURE_ID ON FEATURES_TABLE (FEATURE_ID, RUN_ID);");
+      // features of a run in row key order, used to read a run and to join the dependent tables of a run
+      conn.executeStatement("CREATE INDEX IF NOT EXISTS FEATURES_TABLE_RUN_ID ON FEATURES_TABLE (RUN_ID, ID);");
+      // covering index of per-run RT/m/z queries
+      conn.executeStatement("CREATE INDEX IF NOT EXISTS FEATURES_TABLE_RUN_RT_MZ ON FEATURES_TABLE (RUN_ID, RT, MZ, Intensity);");
+    }
+  }
 
+  // storing helper function
+  // SOFTWARE, SOFTWARE_VERSION, DATA, TIME and ACTIONS values of a dataprocessing entry
+  void addDataProcessingValues_(const DataProcessing& dataprocessing, SQLRow_& row)
+  {
+    row.push_back(SQLValue_(dataprocessing.getSoftware().getName()));
+    row.push_back(SQLValue_(dataprocessing.getSoftware().getVersion()));
+    row.push_back(SQLValue_(dataprocessing.getCompletionTime().getDate()));
+    row.push_back(SQLValue_(dataprocessing.getCompletionTime().getTime()));
+
+    // processingAction entries are stored as comma separated enum values
+    vector<String> processing_actions;
+    for (const DataProcessing::ProcessingAction& a : dataprocessing.getProcessingActions())
+    {
+      processing_actions.push_back(String(static_cast<int>(a)));
+    }
+    row.push_back(SQLValue_(ListUtils::concatenate(processing_actions, ",")));
+  }
 
+  // storing helper function
+  // create dataprocessing table and store one row per dataprocessing entry of feature_map with the ID of feature_map,
+  // userparams in one column per key of any entry (NULL for entries without the key)
+  void writeDataProcessing_(SqliteConnector& conn, const FeatureMap& feature_map)
+  {
+    const vector<DataProcessing>& dataprocessing_userparams = feature_map.getDataProcessing();
+    if (dataprocessing_userparams.empty())
+    {
+      return;
+    }
 
+    // metadata entries of dataprocessing
+    vector<String> dataprocessing_elements_ = {"ID", "SOFTWARE", "SOFTWARE_VERSION", "DATA", "TIME", "ACTIONS"};
+    vector<String> dataprocessing_elements_types_ = {"INTEGER" ,"TEXT" ,"TEXT" ,"TEXT" ,"TEXT" , "TEXT"};
 
+    // union of the (user)parameters of all DataProcessing entries
+    // map with corresponding datatype in dataproc_map_key2type_
+    vector<String> dataproc_keys_;
+    map<String, DataValue::DataType> dataproc_map_key2type_;
+    for (const DataProcessing& dataproc_userparam : dataprocessing_userparams)       // inspect DataProcessing entry 
+    {
+      dataproc_userparam.getKeys(dataproc_keys_);                   // get keys of current dataproc_userparam entry
+      for (const String& key : dataproc_keys_)
+      {
+        dataproc_map_key2type_[key] = dataproc_userparam.getMetaValue(key).valueType(); // save key, datatype pair
+      }
+    }
 
+    // prepare dataprocessing header
+    for (const auto& key2type : dataproc_map_key2type_)
+    { 
+      // set header entries and types 
+      dataprocessing_elements_.push_back(enumToPrefix_(key2type.second).prefix + key2type.first);
+      dataprocessing_elements_types_.push_back(enumToPrefix_(key2type.second).sqltype);
+    }
 
+    // create table, rows are read in the order of the entries
+    // userparam keys may contain any character (invalid identifiers change with SQL dialect), all columns are delimited identifiers
+    conn.executeStatement(createTable_("FEATURES_DATAPROCESSING", tableDefinition_("FEATURES_DATAPROCESSING", dataprocessing_elements_, dataprocessing_elements_types_)));
 
-  ////////////////////////////////////////////////////////////////////////////////////////////////////
-  // read function                                                                                  //
-  ////////////////////////////////////////////////////////////////////////////////////////////////////
+    // one row per dataprocessing entry, bound in column order of dataprocessing_elements_
+    vector<SQLRow_> dataproc_rows;
+    for (const DataProcessing& dataproc_userparam : dataprocessing_userparams)
+    {
+      // featureMap object ID, default values of dataprocessing entry and its userparams
+      SQLRow_ dataproc_elems(1, SQLValue_(static_cast<int64_t>(feature_map.getUniqueId() & ~(1ULL << 63))));
+      addDataProcessingValues_(dataproc_userparam, dataproc_elems);
+      for (const auto& key2type : dataproc_map_key2type_)
+      {
+        dataproc_elems.push_back(dataproc_userparam.metaValueExists(key2type.first) ? toSQLValue_(dataproc_userparam.getMetaValue(key2type.first)) : SQLValue_());
+      }
+      dataproc_rows.push_back(dataproc_elems);
+    }
 
+    //store in dataprocessing table
+    sqlite3* db = conn.getDB();
+    sqlite3_stmt* stmt = nullptr;
+    SqliteConnector::prepareStatement(db, &stmt, createInsert_("FEATURES_DATAPROCESSING", dataprocessing_elements_));
+    insertRows_(db, stmt, dataproc_rows);
+    sqlite3_finalize(stmt);
+  }
 
-  // read BBox values of convex hull entries for feature, subordinate table
-  ConvexHull2D readBBox_(sqlite3_stmt* stmt, int column_nr)
+  // storing helper function
+  // tables of a multi-run file: features with their run, runs catalog and dataprocessing entries by run
+  // ID of a feature is a row key of the file and its unique ID is stored as FEATURE_ID, so runs may reuse unique IDs
+  // (subordinates, convex hulls and sparse meta values belong to a run through their REF_ID, the row key)
+  void createRunTables_(SqliteConnector& conn)
   {
-    double min_MZ = 0.0;
-    Sql::extractValue<double>(&min_MZ, stmt, (column_nr + 1));
-    double min_RT = 0.0;
-    Sql::extractValue<double>(&min_RT, stmt, (column_nr + 2));
-    double max_MZ = 0.0;
-    Sql::extractValue<double>(&max_MZ, stmt, (column_nr + 3));
-    double max_RT = 0.0;
-    Sql::extractValue<double>(&max_RT, stmt, (column_nr + 4));
-
-    ConvexHull2D hull;
-    hull.addPoint({min_MZ, min_RT});
-    hull.addPoint({max_MZ, max_RT});
-    return hull;
+    const TableElements_ core = coreElements_("FEATURES_TABLE");
+    conn.executeStatement(createTable_("FEATURES_TABLE", tableDefinition_("FEATURES_TABLE", core.names, core.types) + ",RUN_ID INTEGER NOT NULL,FEATURE_ID INTEGER NOT NULL"));
+    createRegionIndex_(conn);
+    conn.executeStatement(createTable_("FEATURES_RUNS", "RUN_ID INTEGER PRIMARY KEY,MAP_ID INTEGER NOT NULL,IDENTIFIER TEXT,MS_RUN_PATH BLOB,FEATURES INTEGER NOT NULL"));
+    conn.executeStatement(createTable_("FEATURES_RUN_DATAPROCESSING", "RUN_ID INTEGER NOT NULL,DP_IDX INTEGER NOT NULL,SOFTWARE TEXT,SOFTWARE_VERSION TEXT,DATA TEXT,TIME TEXT,ACTIONS TEXT,PRIMARY KEY (RUN_ID, DP_IDX)"));
   }
 
-  // get values of subordinate, user parameter entries of subordinate table
-  Feature readSubordinate_(sqlite3_stmt * stmt, int column_nr, int cols_features, int cols_subordinates, bool has_bbox)
+  // storing helper function
+  // add feature_map to the runs catalog, returns its run ID
+  int64_t addRun_(sqlite3* db, const FeatureMap& feature_map)
   {
-    Feature subordinate;
-
-    String id_string;
-    Sql::extractValue<String>(&id_string, stmt, cols_features);
-    istringstream iss(id_string);
-    int64_t id_sub = 0;
-    iss >> id_sub;
-
-    double rt = 0.0;
-    Sql::extractValue<double>(&rt, stmt, column_nr + 1);
-    double mz = 0.0;
-    Sql::extractValue<double>(&mz, stmt, column_nr + 2);
-    double intensity = 0.0;
-    Sql::extractValue<double>(&intensity, stmt, column_nr + 3);
-    int charge = 0;
-    Sql::extractValue<int>(&charge, stmt, column_nr + 4);
-    double quality = 0.0;
-    Sql::extractValue<double>(&quality, stmt, column_nr + 5);
-    subordinate.setUniqueId(id_sub);
-    subordinate.setRT(rt);
-    subordinate.setMZ(mz);
-    subordinate.setIntensity(intensity);
-    subordinate.setCharge(charge);
-    subordinate.setOverallQuality(quality);
-
-    // userparams
-
-
+    StringList ms_run_path;
+    feature_map.getPrimaryMSRunPath(ms_run_path);
+
+    SQLRow_ row;
+    row.push_back(SQLValue_(static_cast<int64_t>(feature_map.getUniqueId() & ~(1ULL << 63))));
+    row.push_back(SQLValue_(feature_map.getIdentifier()));
+    row.push_back(toSQLValue_(DataValue(ms_run_path)));
+    row.push_back(SQLValue_(static_cast<int64_t>(feature_map.size())));
+
+    sqlite3_stmt* stmt = nullptr;
+    SqliteConnector::prepareStatement(db, &stmt, createInsert_("FEATURES_RUNS", {"MAP_ID", "IDENTIFIER", "MS_RUN_PATH", "FEATURES"}));
+    insertRows_(db, stmt, vector<SQLRow_>(1, row));
+    sqlite3_finalize(stmt);
+    return sqlite3_last_insert_rowid(db);
+  }
 
-    column_nr = cols_features + 5;  //  offset of 5, represents subordinate parameters
-    for (int i = column_nr; i < cols_features + cols_subordinates  ; ++i) // subordinate userparams - 1 = index of last element in cols_subordinates
+  // storing helper function
+  // store the dataprocessing entries of feature_map as rows of FEATURES_RUN_DATAPROCESSING,
+  // userparams in typed columns added as needed, quoted like those of FEATURES_DATAPROCESSING
+  void writeRunDataProcessing_(SqliteConnector& conn, int64_t run_id, const FeatureMap& feature_map)
+  {
+    const vector<DataProcessing>& dataprocessing = feature_map.getDataProcessing();
+    if (dataprocessing.empty())
     {
-      String column_name = sqlite3_column_name(stmt, i);
-      int column_type = getColumnDatatype_(column_name);
+      return;
+    }
 
-      if (sqlite3_column_type(stmt,i) == SQLITE_NULL) // check for end of table column
-      {
-        break;
-      }
-      // extract current column DataValue type and value
-      else if (column_type == DataValue::STRING_VALUE)
-      {
-        column_name = column_name.substr(3);
-        String value;
-        Sql::extractValue<String>(&value, stmt, i);
-        subordinate.setMetaValue(column_name, value); 
-        continue;
-      } 
-      else if (column_type == DataValue::INT_VALUE)
-      {
-        column_name = column_name.substr(3);
-        int value = 0;
-        Sql::extractValue<int>(&value, stmt, i);
-        subordinate.setMetaValue(column_name, value); 
-        continue;
-      } 
-      else if (column_type == DataValue::DOUBLE_VALUE)
-      {
-        column_name = column_name.substr(3);
-        double value = 0.0;
-        Sql::extractValue<double>(&value, stmt, i);          
-        subordinate.setMetaValue(column_name, value); 
-        continue;
-      } 
-      else if (column_type == DataValue::STRING_LIST)
-      {
-        column_name = column_name.substr(4);
-        String value; 
-        Sql::extractValue<String>(&value, stmt, i);
-
-        StringList sl;
-        value = value.chop(1);  // cut off "[" and "]""
-        value = value.substr(1);
-        value.split(", ", sl);
-        subordinate.setMetaValue(column_name, sl);
-        continue;
-      } 
-      else if (column_type == DataValue::INT_LIST)
-      {
-        column_name = column_name.substr(4);
-        String value; //IntList value;
-        Sql::extractValue<String>(&value, stmt, i); //IntList
-        value = value.chop(1);
-        value = value.substr(1);
-        vector<String> value_list;
-        IntList il = ListUtils::create<int>(value, ',');
-        subordinate.setMetaValue(column_name, il);
-        continue;
-      }
-      else if (column_type == DataValue::DOUBLE_LIST)
-      {
-        column_name = column_name.substr(4);
-        String value; //DoubleList value;
-        Sql::extractValue<String>(&value, stmt, i); //DoubleList
-        value = value.chop(1);
-        value = value.substr(1);          
-        DoubleList dl = ListUtils::create<double>(value, ',');
-        subordinate.setMetaValue(column_name, dl);
-        continue;
-      } 
-      else if (column_type == DataValue::EMPTY_VALUE)
+    map<String, DataValue::DataType> key2type;
+    vector<String> keys;
+    for (const DataProcessing& dp : dataprocessing)
+    {
+      dp.getKeys(keys);
+      for (const String& key : keys)
       {
-        String value;
-        Sql::extractValue<String>(&value, stmt, i);
-        continue;
+        key2type[key] = dp.getMetaValue(key).valueType();
       }
     }
+    vector<String> elements = {"RUN_ID", "DP_IDX", "SOFTWARE", "SOFTWARE_VERSION", "DATA", "TIME", "ACTIONS"};
+    for (const String& column : addMetaColumns_(conn, "FEATURES_RUN_DATAPROCESSING", key2type))
+    {
+      elements.push_back(column);
+    }
 
-    if (has_bbox)
+    vector<SQLRow_> rows;
+    for (Size idx = 0; idx != dataprocessing.size(); ++idx)
     {
-      // add bounding box to current_subordinate
-      column_nr = cols_features + cols_subordinates + 1; // offset of 1, represents REF_ID parameter
-      ConvexHull2D hull = readBBox_(stmt, column_nr);
-      subordinate.getConvexHulls().push_back(hull);
+      SQLRow_ row = {SQLValue_(run_id), SQLValue_(static_cast<int64_t>(idx))};
+      addDataProcessingValues_(dataprocessing[idx], row);
+      for (const auto& k2t : key2type)
+      {
+        row.push_back(dataprocessing[idx].metaValueExists(k2t.first) ? toSQLValue_(dataprocessing[idx].getMetaValue(k2t.first)) : SQLValue_());
+      }
+      rows.push_back(row);
     }
-    return subordinate;
+
+    sqlite3* db = conn.getDB();
+    sqlite3_stmt* stmt = nullptr;
+    SqliteConnector::prepareStatement(db, &stmt, createInsert_("FEATURES_RUN_DATAPROCESSING", elements));
+    insertRows_(db, stmt, rows);
+    sqlite3_finalize(stmt);
   }
 
-
-  int getColumnCount_(sqlite3 *db, sqlite3_stmt *stmt, const String sql)
+  // storing helper function
+  // copy database (built in memory) to filename in one go
+  // VACUUM INTO needs SQLite 3.27, older libraries copy the pages with the online backup API
+  void vacuumInto_(sqlite3* db, const String& filename)
   {
-    SqliteConnector::prepareStatement(db, &stmt, sql);
-    sqlite3_step(stmt);
-    int column_count = sqlite3_column_count(stmt);
+    if (sqlite3_libversion_number() < 3027000)
+    {
+      sqlite3* file_db = nullptr;
+      int rc = sqlite3_open(filename.c_str(), &file_db);
+      sqlite3_backup* backup = rc == SQLITE_OK ? sqlite3_backup_init(file_db, "main", db, "main") : nullptr;
+      if (backup != nullptr)
+      {
+        sqlite3_backup_step(backup, -1);
+        sqlite3_backup_finish(backup);
+        rc = sqlite3_errcode(file_db);
+      }
+      const String error = file_db != nullptr ? String(sqlite3_errmsg(file_db)) : String(sqlite3_errstr(rc));
+      sqlite3_close(file_db);
+      if (backup == nullptr || rc != SQLITE_OK)
+      {
+        throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Error copying in-memory database to '" + filename + "': " + error);
+      }
+      return;
+    }
+    sqlite3_stmt* stmt = nullptr;
+    SqliteConnector::prepareStatement(db, &stmt, "VACUUM INTO ?;");
+    checkBind_(db, sqlite3_bind_text(stmt, 1, filename.c_str(), static_cast<int>(filename.size()), SQLITE_STATIC));
+    stepStatement_(db, stmt);
     sqlite3_finalize(stmt);
+  }
 
-    return column_count;
+  // storing helper function
+  // optional indices of FEATURES_TABLE for filtered reads (ReadOptions), keys not stored are ignored
+  void createFilterIndices_(SqliteConnector& conn, const FeatureSQLFile::WriteOptions& options, const vector<String>& feature_elements)
+  {
+    vector<String> columns;
+    if (options.index_core_columns)
+    {
+      columns = {"Intensity", "Quality", "Charge"};
+    }
+    for (const String& name : feature_elements)
+    {
+      if (getColumnDatatype_(name) != DataValue::EMPTY_VALUE && options.indexed_meta_keys.count(name.substr(name.find('_', 1) + 1)) != 0)
+      {
+        columns.push_back(name);
+      }
+    }
+    for (const String& column : columns)
+    {
+      conn.executeStatement("CREATE INDEX IF NOT EXISTS " + quoteIdentifier_("FEATURES_TABLE_" + column) + " ON FEATURES_TABLE (" + quoteIdentifier_(column) + ");");
+    }
   }
 
-  //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-  //                                                   read FeatureMap as SQL database                                                    //
-  //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-  // read SQL database and store as FeatureMap
-  // fitted snippet of FeatureXMLFile::load
-  // based on TransitionPQPFile::readPQPInput
+  // version of the featureSQL schema stored in FEATURES_SUMMARY
+  const Int schema_version_ = 1;
 
-  FeatureMap FeatureSQLFile::read(const string& filename_) const
+  // helper function
+  // number of rows of a table, 0 if it does not exist
+  Size countRows_(sqlite3* db, const String& table)
   {
-    FeatureMap feature_map; // FeatureMap object as feature container
-
-    sqlite3 *db;
-    sqlite3_stmt * stmt = NULL;
-    string select_sql;
+    if (!SqliteConnector::tableExists(db, table))
+    {
+      return 0;
+    }
+    sqlite3_stmt* stmt = nullptr;
+    SqliteConnector::prepareStatement(db, &stmt, "SELECT COUNT(*) FROM " + table + ";");
+    sqlite3_step(stmt);
+    const Size count = static_cast<Size>(sqlite3_column_int64(stmt, 0));
+    sqlite3_finalize(stmt);
+    return count;
+  }
 
-    SqliteConnector conn(filename_); // Open database
-    db = conn.getDB();
+  // helper function
+  // meta keys of the userparam columns of a table and their types
+  map<String, DataValue::DataType> storedMetaKeys_(sqlite3* db, const String& table)
+  {
+    map<String, DataValue::DataType> key2type;
+    if (!SqliteConnector::tableExists(db, table))
+    {
+      return key2type;
+    }
+    for (const String& name : getColumnNames_(db, table))
+    {
+      const DataValue::DataType type = getColumnDatatype_(name);
+      if (type != DataValue::EMPTY_VALUE)
+      {
+        key2type[name.substr(name.find('_', 1) + 1)] = type;
+      }
+    }
+    if (table == "FEATURES_TABLE")
+    {
+      for (const auto& sparse_key : storedSparseKeys_(db))
+      {
+        key2type[sparse_key.first] = sparse_key.second.second;
+      }
+    }
+    return key2type;
+  }
 
+  // helper function
+  // table of the dataprocessing entries: those of all runs in multi-run files
+  String dataProcessingTable_(sqlite3* db)
+  {
+    return SqliteConnector::tableExists(db, "FEATURES_RUN_DATAPROCESSING") ? "FEATURES_RUN_DATAPROCESSING" : "FEATURES_DATAPROCESSING";
+  }
 
+  // helper function
+  // compute summary from the stored tables with aggregate queries (schema_version is left at 0)
+  FeatureSQLFile::Summary computeSummary_(sqlite3* db)
+  {
+    FeatureSQLFile::Summary summary;
+    summary.features = countRows_(db, "FEATURES_TABLE");
+    summary.subordinates = countRows_(db, "FEATURES_SUBORDINATES");
+    summary.feature_hulls = countRows_(db, "FEATURES_TABLE_BOUNDINGBOX");
+    summary.subordinate_hulls = countRows_(db, "SUBORDINATES_TABLE_BOUNDINGBOX");
+    summary.dataprocessing = countRows_(db, dataProcessingTable_(db));
+    summary.region_index = SqliteConnector::tableExists(db, "FEATURES_REGION_INDEX");
+
+    sqlite3_stmt* stmt = nullptr;
+    if (summary.features > 0)
+    {
+      SqliteConnector::prepareStatement(db, &stmt, "SELECT MIN(RT), MAX(RT), MIN(MZ), MAX(MZ), MIN(Intensity), MAX(Intensity) FROM FEATURES_TABLE;");
+      sqlite3_step(stmt);
+      summary.rt_min = sqlite3_column_double(stmt, 0);
+      summary.rt_max = sqlite3_column_double(stmt, 1);
+      summary.mz_min = sqlite3_column_double(stmt, 2);
+      summary.mz_max = sqlite3_column_double(stmt, 3);
+      summary.intensity_min = sqlite3_column_double(stmt, 4);
+      summary.intensity_max = sqlite3_column_double(stmt, 5);
+      sqlite3_finalize(stmt);
+    }
+    if (summary.feature_hulls > 0)
+    {
+      // hull X (RT) is stored in min_MZ/max_MZ
+      SqliteConnector::prepareStatement(db, &stmt, "SELECT MIN(min_MZ), MAX(max_MZ), MIN(min_RT), MAX(max_RT) FROM FEATURES_TABLE_BOUNDINGBOX;");
+      sqlite3_step(stmt);
+      summary.rt_min = std::min(summary.rt_min, sqlite3_column_double(stmt, 0));
+      summary.rt_max = std::max(summary.rt_max, sqlite3_column_double(stmt, 1));
+      summary.mz_min = std::min(summary.mz_min, sqlite3_column_double(stmt, 2));
+      summary.mz_max = std::max(summary.mz_max, sqlite3_column_double(stmt, 3));
+      sqlite3_finalize(stmt);
+    }
 
-    // set switches to access only existent tables
-    bool features_switch_ = SqliteConnector::tableExists(db, "FEATURES_TABLE");
-    bool subordinates_switch_ = SqliteConnector::tableExists(db, "FEATURES_SUBORDINATES");
-    bool dataprocessing_switch_ = SqliteConnector::tableExists(db, "FEATURES_DATAPROCESSING");
-    bool features_bbox_switch_ = SqliteConnector::tableExists(db, "FEATURES_TABLE_BOUNDINGBOX");
-    bool subordinates_bbox_switch_ = SqliteConnector::tableExists(db, "SUBORDINATES_TABLE_BOUNDINGBOX");
+    summary.feature_meta_keys = storedMetaKeys_(db, "FEATURES_TABLE");
+    summary.subordinate_meta_keys = storedMetaKeys_(db, "FEATURES_SUBORDINATES");
+    summary.dataprocessing_meta_keys = storedMetaKeys_(db, dataProcessingTable_(db));
+    return summary;
+  }
 
-    //////////////////////////////////////////////////////////////////////////////////////////
-    // store sqlite3 database as FeatureMap                                                 //
-    // 1. features                                                                          //                                    
-    // 2. subordinates                                                                      //
-    // 3. boundingbox                                                                       //
-    // 4. dataprocessing                                                                    //
-    //////////////////////////////////////////////////////////////////////////////////////////
-    
-    String sql;
-    String features_sql;
-    String subordinates_sql;
+  // storing helper function
+  // summary stored in FEATURES_SUMMARY with its meta key catalog, computed from the stored features for files without
+  FeatureSQLFile::Summary readSummary_(sqlite3* db)
+  {
+    if (!SqliteConnector::tableExists(db, "FEATURES_SUMMARY"))
+    {
+      return computeSummary_(db);
+    }
 
-    int cols_features = 0;
-    int cols_subordinates = 0;
-    int cols_features_bbox = 0;
-    int cols_subordinates_bbox = 0;
+    FeatureSQLFile::Summary summary;
+    sqlite3_stmt* stmt = nullptr;
+    SqliteConnector::prepareStatement(db, &stmt, "SELECT * FROM FEATURES_SUMMARY;");
+    if (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+      summary.schema_version = sqlite3_column_int(stmt, 0);
+      summary.features = static_cast<Size>(sqlite3_column_int64(stmt, 1));
+      summary.subordinates = static_cast<Size>(sqlite3_column_int64(stmt, 2));
+      summary.feature_hulls = static_cast<Size>(sqlite3_column_int64(stmt, 3));
+      summary.subordinate_hulls = static_cast<Size>(sqlite3_column_int64(stmt, 4));
+      summary.dataprocessing = static_cast<Size>(sqlite3_column_int64(stmt, 5));
+      summary.region_index = sqlite3_column_int(stmt, 6) != 0;
+      summary.rt_min = sqlite3_column_double(stmt, 7);
+      summary.rt_max = sqlite3_column_double(stmt, 8);
+      summary.mz_min = sqlite3_column_double(stmt, 9);
+      summary.mz_max = sqlite3_column_double(stmt, 10);
+      summary.intensity_min = sqlite3_column_double(stmt, 11);
+      summary.intensity_max = sqlite3_column_double(stmt, 12);
+    }
+    sqlite3_finalize(stmt);
 
-    // check existence of tables in database
-    // fit queries according to present tables
-    // get number of columns for each table except dataprocessing
+    SqliteConnector::prepareStatement(db, &stmt, "SELECT TABLE_NAME, META_KEY, VALUE_TYPE FROM FEATURES_META_KEYS;");
+    while (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+      const String table = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+      const String key = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+      const DataValue::DataType type = static_cast<DataValue::DataType>(sqlite3_column_int(stmt, 2));
+      if (table == "FEATURES_TABLE")
+      {
+        summary.feature_meta_keys[key] = type;
+      }
+      else if (table == "FEATURES_SUBORDINATES")
+      {
+        summary.subordinate_meta_keys[key] = type;
+      }
+      else
+      {
+        summary.dataprocessing_meta_keys[key] = type;
+      }
+    }
+    sqlite3_finalize(stmt);
+    return summary;
+  }
 
-    //////////////////////////////////////////////////////////////////////////////////////////
-    // 1. features
-    //////////////////////////////////////////////////////////////////////////////////////////
-    if (features_switch_)
+  // storing helper function
+  // counts and ranges (as computeSummary_) of the features of feature_map
+  FeatureSQLFile::Summary mapSummary_(const FeatureMap& feature_map)
+  {
+    FeatureSQLFile::Summary summary;
+    summary.features = feature_map.size();
+    if (feature_map.empty())
     {
-      sql = "SELECT * FROM FEATURES_TABLE;";
-      cols_features = getColumnCount_(db, stmt, sql);
-      //cout << "Number of columns for cols_features = " << cols_features << endl;
+      return summary;
     }
-    else if (!features_switch_)
+    summary.rt_min = summary.mz_min = summary.intensity_min = numeric_limits<double>::max();
+    summary.rt_max = summary.mz_max = summary.intensity_max = -numeric_limits<double>::max();
+    for (const Feature& feature : feature_map)
     {
-      //cout << "NO FEATURES" << endl;
+      summary.rt_min = std::min(summary.rt_min, feature.getRT());
+      summary.rt_max = std::max(summary.rt_max, feature.getRT());
+      summary.mz_min = std::min(summary.mz_min, feature.getMZ());
+      summary.mz_max = std::max(summary.mz_max, feature.getMZ());
+      summary.intensity_min = std::min(summary.intensity_min, static_cast<double>(feature.getIntensity()));
+      summary.intensity_max = std::max(summary.intensity_max, static_cast<double>(feature.getIntensity()));
+      summary.feature_hulls += feature.getConvexHulls().size();
+      for (const ConvexHull2D& hull : feature.getConvexHulls())
+      {
+        const DBoundingBox<2> bbox = hull.getBoundingBox();
+        summary.rt_min = std::min(summary.rt_min, bbox.minX());
+        summary.rt_max = std::max(summary.rt_max, bbox.maxX());
+        summary.mz_min = std::min(summary.mz_min, bbox.minY());
+        summary.mz_max = std::max(summary.mz_max, bbox.maxY());
+      }
+      summary.subordinates += feature.getSubordinates().size();
+      for (const Feature& subordinate : feature.getSubordinates())
+      {
+        summary.subordinate_hulls += subordinate.getConvexHulls().size();
+      }
     }
+    return summary;
+  }
 
-    //////////////////////////////////////////////////////////////////////////////////////////
-    // 2. subordinates
-    //////////////////////////////////////////////////////////////////////////////////////////
-    if (subordinates_switch_)
+  // storing helper function
+  // summary of a file after the features of feature_map were added (added = true) or updated by the current transaction,
+  // from the summary stored before instead of scanning the tables; ranges grow by those of feature_map
+  // (after updates, they may still include values no longer stored)
+  FeatureSQLFile::Summary extendedSummary_(sqlite3* db, const FeatureSQLFile::Summary& before, const FeatureMap& feature_map, bool added)
+  {
+    FeatureSQLFile::Summary summary = before;
+    const FeatureSQLFile::Summary written = mapSummary_(feature_map);
+    if (written.features > 0)
     {
-      sql = "SELECT * FROM FEATURES_SUBORDINATES;";
-      cols_subordinates = getColumnCount_(db, stmt, sql);
-      //cout << "Number of columns for cols_subordinates = " << cols_subordinates<< endl;
+      const bool empty = before.features == 0;
+      summary.rt_min = empty ? written.rt_min : std::min(before.rt_min, written.rt_min);
+      summary.rt_max = empty ? written.rt_max : std::max(before.rt_max, written.rt_max);
+      summary.mz_min = empty ? written.mz_min : std::min(before.mz_min, written.mz_min);
+      summary.mz_max = empty ? written.mz_max : std::max(before.mz_max, written.mz_max);
+      summary.intensity_min = empty ? written.intensity_min : std::min(before.intensity_min, written.intensity_min);
+      summary.intensity_max = empty ? written.intensity_max : std::max(before.intensity_max, written.intensity_max);
     }
-    else if (!subordinates_switch_)
+    if (added)
     {
-      //cout << "NO SUBORDINATES" << endl;
+      summary.features += written.features;
+      summary.subordinates += written.subordinates;
+      summary.feature_hulls += written.feature_hulls;
+      summary.subordinate_hulls += written.subordinate_hulls;
     }
-  
-    //////////////////////////////////////////////////////////////////////////////////////////
-    // 3. features bbox
-    //////////////////////////////////////////////////////////////////////////////////////////
-    if (features_bbox_switch_)
+    // catalog lookups only
+    summary.region_index = SqliteConnector::tableExists(db, "FEATURES_REGION_INDEX");
+    summary.feature_meta_keys = storedMetaKeys_(db, "FEATURES_TABLE");
+    summary.subordinate_meta_keys = storedMetaKeys_(db, "FEATURES_SUBORDINATES");
+    // writeRun() also stores the dataprocessing entries of its run, append() is rejected for multi-run files
+    if (added && SqliteConnector::tableExists(db, "FEATURES_RUN_DATAPROCESSING"))
     {
-      sql = "SELECT * FROM FEATURES_TABLE_BOUNDINGBOX;";
-      cols_features_bbox = getColumnCount_(db, stmt, sql);
-      //cout << "Number of columns for cols_feature_bbox = " << cols_features_bbox << endl;
+      summary.dataprocessing += feature_map.getDataProcessing().size();
+      summary.dataprocessing_meta_keys = storedMetaKeys_(db, "FEATURES_RUN_DATAPROCESSING");
     }
-    else if (!features_bbox_switch_)
+    return summary;
+  }
+
+  // storing helper function
+  // (re)write FEATURES_SUMMARY (a single row) and the meta key catalog FEATURES_META_KEYS read by stat()
+  void writeSummary_(SqliteConnector& conn, const FeatureSQLFile::Summary& summary)
+  {
+    sqlite3* db = conn.getDB();
+
+    conn.executeStatement("DROP TABLE IF EXISTS FEATURES_SUMMARY;");
+    conn.executeStatement("DROP TABLE IF EXISTS FEATURES_META_KEYS;");
+    conn.executeStatement("CREATE TABLE FEATURES_SUMMARY (SCHEMA_VERSION INTEGER, FEATURES INTEGER, SUBORDINATES INTEGER, FEATURE_HULLS INTEGER, \
+                           SUBORDINATE_HULLS INTEGER, DATAPROCESSING INTEGER, REGION_INDEX INTEGER, min_RT REAL, max_RT REAL, min_MZ REAL, \
+                           max_MZ REAL, min_Intensity REAL, max_Intensity REAL);");
+    conn.executeStatement("CREATE TABLE FEATURES_META_KEYS (TABLE_NAME TEXT, META_KEY TEXT, VALUE_TYPE INTEGER);");
+
+    sqlite3_stmt* stmt = nullptr;
+    SqliteConnector::prepareStatement(db, &stmt, "INSERT INTO FEATURES_SUMMARY VALUES (?,?,?,?,?,?,?,?,?,?,?,?,?);");
+    SQLRow_ row = {SQLValue_(static_cast<int64_t>(schema_version_)), SQLValue_(static_cast<int64_t>(summary.features)),
+                   SQLValue_(static_cast<int64_t>(summary.subordinates)), SQLValue_(static_cast<int64_t>(summary.feature_hulls)),
+                   SQLValue_(static_cast<int64_t>(summary.subordinate_hulls)), SQLValue_(static_cast<int64_t>(summary.dataprocessing)),
+                   SQLValue_(static_cast<int64_t>(summary.region_index)), SQLValue_(summary.rt_min), SQLValue_(summary.rt_max),
+                   SQLValue_(summary.mz_min), SQLValue_(summary.mz_max), SQLValue_(summary.intensity_min), SQLValue_(summary.intensity_max)};
+    insertRows_(db, stmt, vector<SQLRow_>(1, row));
+    sqlite3_finalize(stmt);
+
+    vector<SQLRow_> key_rows;
+    const vector<pair<String, const map<String, DataValue::DataType>*> > catalog = {{"FEATURES_TABLE", &summary.feature_meta_keys},
+                                                                                  {"FEATURES_SUBORDINATES", &summary.subordinate_meta_keys},
+                                                                                  {"FEATURES_DATAPROCESSING", &summary.dataprocessing_meta_keys}};
+    for (const auto& table : catalog)
     {
-      //cout << "NO BBOXES OF FEATURES" << endl;
+      for (const auto& k2t : *table.second)
+      {
+        key_rows.push_back({SQLValue_(table.first), SQLValue_(k2t.first), SQLValue_(static_cast<int64_t>(k2t.second))});
+      }
     }
+    SqliteConnector::prepareStatement(db, &stmt, "INSERT INTO FEATURES_META_KEYS VALUES (?,?,?);");
+    insertRows_(db, stmt, key_rows);
+    sqlite3_finalize(stmt);
+  }
 
+  // storing helper function
+  // hull point encoding of a file given by the first stored hull points, HULL_BOUNDINGBOX if there are none
+  FeatureSQLFile::HullPoints storedHullPoints_(sqlite3* db)
+  {
+    FeatureSQLFile::HullPoints encoding = FeatureSQLFile::HULL_BOUNDINGBOX;
+    for (const String& table : vector<String>{"FEATURES_TABLE_BOUNDINGBOX", "SUBORDINATES_TABLE_BOUNDINGBOX"})
+    {
+      if (encoding != FeatureSQLFile::HULL_BOUNDINGBOX || !SqliteConnector::tableExists(db, table) || !SqliteConnector::columnExists(db, table, "POINTS"))
+      {
+        continue;
+      }
+      sqlite3_stmt* stmt = nullptr;
+      SqliteConnector::prepareStatement(db, &stmt, "SELECT POINTS FROM " + table + " WHERE POINTS IS NOT NULL LIMIT 1;");
+      if (sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_bytes(stmt, 0) > 0)
+      {
+        const int stored = static_cast<const unsigned char*>(sqlite3_column_blob(stmt, 0))[0];
+        if (stored > FeatureSQLFile::HULL_BOUNDINGBOX && stored < FeatureSQLFile::SIZE_OF_HULLPOINTS)
+        {
+          encoding = static_cast<FeatureSQLFile::HullPoints>(stored);
+        }
+      }
+      sqlite3_finalize(stmt);
+    }
+    return encoding;
+  }
 
-    //////////////////////////////////////////////////////////////////////////////////////////
-    // 4. subordinates bbox
-    //////////////////////////////////////////////////////////////////////////////////////////
-    if (subordinates_bbox_switch_)
+  // storing helper function
+  // positions of the dictionary encoded columns among elements
+  vector<Size> dictionaryColumns_(const vector<String>& elements)
+  {
+    vector<Size> positions;
+    for (Size pos = 0; pos != elements.size(); ++pos)
     {
-      sql = "SELECT * FROM SUBORDINATES_TABLE_BOUNDINGBOX;";
-      cols_subordinates_bbox = getColumnCount_(db, stmt, sql);
-      //cout << "Number of columns for cols_subodinate_bbox = " << cols_subordinates_bbox << endl;
+      if (elements[pos].hasPrefix("_SD_"))
+      {
+        positions.push_back(pos);
+      }
     }
-    else if (!subordinates_bbox_switch_)
+    return positions;
+  }
+
+  // storing helper function
+  // prepare the INSERT statement of the string dictionary shared by all dictionary encoded columns,
+  // the table is created on first use and the codes stored before are loaded once
+  void prepareDictionary_(sqlite3* db, SQLStatements_& statements)
+  {
+    if (!SqliteConnector::tableExists(db, "FEATURES_STRING_DICTIONARY"))
     {
-      //cout << "NO BBOXES OF SUBORDINATES" << endl;
+      SqliteConnector::executeStatement(db, "CREATE TABLE FEATURES_STRING_DICTIONARY (CODE INTEGER PRIMARY KEY, VALUE TEXT NOT NULL UNIQUE);");
     }
-    
-  /*  
-    //////////////////////////////////////////////////////////////////////////////////////////
-    // 5. concatenation features bbox
-    //////////////////////////////////////////////////////////////////////////////////////////
-    String features_sql = "SELECT * FROM  FEATURES_TABLE \
-                            LEFT JOIN FEATURES_TABLE_BOUNDINGBOX ON FEATURES_TABLE.id = FEATURES_TABLE_BOUNDINGBOX.ref_id \
-                            ORDER BY FEATURES_TABLE.ID, FEATURES_TABLE_BOUNDINGBOX.BB_IDX;";
-    int cols_features_join_bbox = getColumnCount_(db, stmt, sql);
-    cout << "Number of columns of feature join bbox = " << cols_features_join_bbox << endl;
-
-    // 6. concatenation features subordinates bbox 
-    //sql = "SELECT * FROM  FEATURES_TABLE LEFT JOIN FEATURES_SUBORDINATES ON FEATURES_TABLE.id = FEATURES_SUBORDINATES.ref_id LEFT JOIN SUBORDINATES_TABLE_BOUNDINGBOX ON FEATURES_SUBORDINATES.id = SUBORDINATES_TABLE_BOUNDINGBOX.id ORDER BY FEATURES_TABLE.ID;";
-    
-    String subordinates_sql = "SELECT * FROM  FEATURES_TABLE LEFT JOIN FEATURES_SUBORDINATES ON FEATURES_TABLE.id = FEATURES_SUBORDINATES.ref_id \
-                                LEFT JOIN SUBORDINATES_TABLE_BOUNDINGBOX ON FEATURES_SUBORDINATES.id = SUBORDINATES_TABLE_BOUNDINGBOX.id \
-                                ORDER BY FEATURES_TABLE.ID, FEATURES_SUBORDINATES.sub_idx,SUBORDINATES_TABLE_BOUNDINGBOX.bb_idx;";
-    int cols_features_join_subordinates_join_bbox = getColumnCount_(db, stmt, sql);
-    cout << "Number of columns of subordinate join bbox = " << cols_features_join_subordinates_join_bbox << endl;
-  */
+    else if (statements.dictionary_codes.empty())
+    {
+      sqlite3_stmt* stmt = nullptr;
+      SqliteConnector::prepareStatement(db, &stmt, "SELECT CODE, VALUE FROM FEATURES_STRING_DICTIONARY;");
+      while (sqlite3_step(stmt) == SQLITE_ROW)
+      {
+        statements.dictionary_codes.emplace(std::string(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)), sqlite3_column_bytes(stmt, 1)),
+                                            sqlite3_column_int64(stmt, 0));
+      }
+      sqlite3_finalize(stmt);
+    }
+    SqliteConnector::prepareStatement(db, &statements.dictionary, "INSERT INTO FEATURES_STRING_DICTIONARY (CODE, VALUE) VALUES (?,?);");
+  }
 
-    //////////////////////////////////////////////////////////////////////////////////////////
-    // check cases of database content
-    // 1. only features
-    // 2. features and subordinates but no bboxes
-    // 3. features and subordinates with feature boundingbox
-    // 4. features and subordinates with feature and subordinate boundingbox
-    //////////////////////////////////////////////////////////////////////////////////////////
-    
-    // 1.
-    if (features_switch_ && !subordinates_switch_)  
+  // storing helper function
+  // prepare INSERT statements of the feature related tables, for the columns of feature_elements and subordinate_elements
+  // (empty: table not written); features of a multi-run file get run_id (negative: none)
+  void prepareInserts_(sqlite3* db, SQLStatements_& statements, const vector<String>& feature_elements, const vector<String>& subordinate_elements,
+                       bool features_bbox, bool subordinates_bbox, int64_t run_id = -1)
+  {
+    statements.feature_dictionary_columns = dictionaryColumns_(feature_elements);
+    statements.subordinate_dictionary_columns = dictionaryColumns_(subordinate_elements);
+    if (!statements.feature_dictionary_columns.empty() || !statements.subordinate_dictionary_columns.empty())
     {
-      cout << "###########################  case 1  ##################################### "  << endl; 
-      features_sql = "SELECT * FROM  FEATURES_TABLE";
-    } 
-    // 2.
-    else if (features_switch_ && subordinates_switch_ && !features_bbox_switch_) // features have subordinates but no bbox
+      prepareDictionary_(db, statements);
+    }
+    if (!feature_elements.empty())
     {
-      cout << "############################   case 2  #################################### "  << endl; 
-      features_sql = "SELECT * FROM  FEATURES_TABLE";
-      subordinates_sql = "SELECT * FROM  FEATURES_TABLE LEFT JOIN FEATURES_SUBORDINATES ON FEATURES_TABLE.id = FEATURES_SUBORDINATES.ref_id \
-                                ORDER BY FEATURES_TABLE.ID, FEATURES_SUBORDINATES.sub_idx;";
+      map<String, String> fixed_values;
+      if (run_id >= 0)
+      {
+        fixed_values["RUN_ID"] = String(static_cast<long long>(run_id));
+      }
+      SqliteConnector::prepareStatement(db, &statements.features, createInsert_("FEATURES_TABLE", feature_elements, fixed_values));
     }
-    // 3.
-    else if (features_switch_ && subordinates_switch_ && features_bbox_switch_ && !subordinates_bbox_switch_) // 
+    if (!feature_elements.empty() && SqliteConnector::tableExists(db, "FEATURES_REGION_INDEX"))
     {
-      cout << "############################    case 3  #################################### "  << endl; 
-
-      features_sql = "SELECT * FROM  FEATURES_TABLE \
-                            LEFT JOIN FEATURES_TABLE_BOUNDINGBOX ON FEATURES_TABLE.id = FEATURES_TABLE_BOUNDINGBOX.ref_id \
-                            ORDER BY FEATURES_TABLE.ID, FEATURES_TABLE_BOUNDINGBOX.BB_IDX;";
-    
-      subordinates_sql = "SELECT * FROM  FEATURES_TABLE LEFT JOIN FEATURES_SUBORDINATES ON FEATURES_TABLE.id = FEATURES_SUBORDINATES.ref_id \
-                                ORDER BY FEATURES_TABLE.ID, FEATURES_SUBORDINATES.sub_idx;";
+      SqliteConnector::prepareStatement(db, &statements.region_index, "INSERT INTO FEATURES_REGION_INDEX (ID, min_RT, max_RT, min_MZ, max_MZ) VALUES (?,?,?,?,?);");
     }
-    // 4.
-    else if (features_switch_ && subordinates_switch_ && features_bbox_switch_ && subordinates_bbox_switch_) // features have subordinates and bboxes
+    if (!feature_elements.empty() && SqliteConnector::tableExists(db, "FEATURES_SPARSE_META"))
     {
-
-
-      cout << "###############################    case 4   ################################# "  << endl; 
-      features_sql = "SELECT * FROM  FEATURES_TABLE \
-                            LEFT JOIN FEATURES_TABLE_BOUNDINGBOX ON FEATURES_TABLE.id = FEATURES_TABLE_BOUNDINGBOX.ref_id \
-                            ORDER BY FEATURES_TABLE.ID, FEATURES_TABLE_BOUNDINGBOX.BB_IDX;";
-    
-      subordinates_sql = "SELECT * FROM  FEATURES_TABLE LEFT JOIN FEATURES_SUBORDINATES ON FEATURES_TABLE.id = FEATURES_SUBORDINATES.ref_id \
-                                LEFT JOIN SUBORDINATES_TABLE_BOUNDINGBOX ON FEATURES_SUBORDINATES.id = SUBORDINATES_TABLE_BOUNDINGBOX.id \
-                                ORDER BY FEATURES_TABLE.ID, FEATURES_SUBORDINATES.sub_idx,SUBORDINATES_TABLE_BOUNDINGBOX.bb_idx;";
+      SqliteConnector::prepareStatement(db, &statements.sparse_meta, "INSERT INTO FEATURES_SPARSE_META (REF_ID, KEY_ID, VALUE) VALUES (?,?,?);");
     }
-  
-
-    cout << "sql = \t " << sql  << endl; 
-    cout << "features_sql = \t" << features_sql << endl; 
-    cout << "subordinates_sql = \t" << subordinates_sql << endl; 
-
-
-
-    //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    //                                                  sqlite3 database readout into FeatureMap                                            //
-    //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    
-    // access table entries and insert into FeatureMap feature_map 
-    // begin dataprocessing #####################################
-    if (dataprocessing_switch_)
+    if (features_bbox)
     {
-      /// 1. get feature data from database
-      String sql = "SELECT * FROM  FEATURES_DATAPROCESSING;";
-      SqliteConnector::prepareStatement(db, &stmt, sql);
-      //SqliteConnector::executePreparedStatement(db, &stmt, sql);
-      sqlite3_step(stmt);
+      SqliteConnector::prepareStatement(db, &statements.feature_bboxes, createInsert_("FEATURES_TABLE_BOUNDINGBOX", coreElements_("FEATURES_TABLE_BOUNDINGBOX").names));
+    }
+    if (!subordinate_elements.empty())
+    {
+      SqliteConnector::prepareStatement(db, &statements.subordinates, createInsert_("FEATURES_SUBORDINATES", subordinate_elements));
+    }
+    if (subordinates_bbox)
+    {
+      SqliteConnector::prepareStatement(db, &statements.subordinate_bboxes, createInsert_("SUBORDINATES_TABLE_BOUNDINGBOX", coreElements_("SUBORDINATES_TABLE_BOUNDINGBOX").names));
+    }
+  }
 
-      while (sqlite3_column_type( stmt, 0 ) != SQLITE_NULL)
+  // storing helper function
+  // insert rows of all features into the feature related tables
+  // features are cut into chunks, a window of chunks is converted into rows by the worker threads
+  // while the master thread (the only one talking to SQLite) inserts the rows of the previous window,
+  // so at most two windows of rows are buffered independent of the size of the map
+  // first_row_id: row key of the first feature of a multi-run file, the following ones are consecutive (negative: unique IDs are the row keys)
+  void insertFeatures_(sqlite3* db, SQLStatements_& statements, const FeatureMap& feature_map, const vector<UInt>& feature_keys, const vector<UInt>& subordinate_keys,
+                       const SparseKeys_& sparse_keys, FeatureSQLFile::HullPoints hull_points, int64_t first_row_id = -1)
+  {
+    const Size chunk_size = 256;
+    Size window_size = 4; // chunks per window
+#ifdef _OPENMP
+    window_size *= omp_get_max_threads();
+#endif
+    const Size n_chunks = (feature_map.size() + chunk_size - 1) / chunk_size;
+    const Size n_windows = (n_chunks + window_size - 1) / window_size;
+    vector<vector<SQLBatch_> > buffers(2, vector<SQLBatch_>(window_size));
+    String write_error;
+
+#pragma omp parallel
+    {
+      for (Size w = 0; w <= n_windows; ++w)
       {
-
-        // set dataprocessing parameters
-        String id_s;
-        size_t id = 0;
-
-        // extract as String TODO
-        Sql::extractValue<String>(&id_s, stmt, 0);
-        istringstream iss(id_s);
-        iss >> id;
-
-        // String id_s;
-        // int64_t id = 0;
-        // Sql::extractValue<String>(&id_s, stmt, 0);
-        // istringstream iss(id_s);
-        // iss >> id;
-
-
-        String software;
-        Sql::extractValue<String>(&software, stmt, 1);
-        String software_name;
-        Sql::extractValue<String>(&software_name, stmt, 2);
-        String data;
-        Sql::extractValue<String>(&data, stmt, 3);
-        String time;
-        Sql::extractValue<String>(&time, stmt, 4);
-        String actions;
-        Sql::extractValue<String>(&actions, stmt, 5);
-
-        // get values
-        // id, RT, MZ, Intensity, Charge, Quality
-        // save SQL column elements as feature
-        feature_map.setUniqueId(id);
-        DataProcessing dp;
-
-        //software
-        dp.getSoftware().setName(software);
-        dp.getSoftware().setVersion(software_name);
-
-        //time
-        DateTime date_time;
-        date_time.set(data + " " + time);
-        dp.setCompletionTime(date_time);
-
-        // split into String vector
-        // split into Integer vector
-        StringList proc_acts;
-        
-        if (actions.hasSubstring(","))
-        {
-          cout << "Test output for MetaboIdent_1" << endl;
-          //cout << "Actions: " << actions << endl;
-          actions.split(",", proc_acts);
-          //cout << proc_acts[0];
-          //cout << "StringList size for MetaboIdent_1 xml is: " << proc_acts.size() << endl;
-          //cout << "all actions concatenated: " <<  ListUtils::concatenate(proc_acts, ",")  << endl;
-        }
-        else
+        // writer: insert rows of previous window
+#pragma omp master
         {
-          proc_acts[0] = actions;
-        }
- 
-        cout << "Test output for MetaboIdent_1" << proc_acts[0] << endl;
-        cout << "all actions concatenated: " <<  ListUtils::concatenate(proc_acts, ",")  << endl;
-        cout << "Test output for MetaboIdent_1" <<  proc_acts[0].toInt() << endl;
-        
-
-        // iterate across vector and add to set
-        //actions
-        set<DataProcessing::ProcessingAction> proc_actions;
-
-        for (auto action : proc_acts)
-        {
-          proc_actions.insert((DataProcessing::ProcessingAction)action.toInt());
-        }
- 
-        /*
-          for (int i = 0; i < DataProcessing::SIZE_OF_PROCESSINGACTION; ++i)
+          if (w > 0 && write_error.empty())
           {
-            //String test = setText(QString::fromStdString(DataProcessing::NamesOfProcessingAction[i]));
-            //cout << "String version of enum at position: " << i << " = " << test << "\n"; 
-            if (actions == DataProcessing::NamesOfProcessingAction[i])
+            try
+            {
+              for (SQLBatch_& batch : buffers[(w - 1) % 2])
+              {
+                insertBatch_(db, statements, batch);
+                batch = SQLBatch_();
+              }
+            }
+            catch (Exception::BaseException& e)
             {
-              proc_actions.insert((DataProcessing::ProcessingAction)i);
+              write_error = e.what();
             }
           }
-        */
-     
-        // set processing actions
-        dp.setProcessingActions(proc_actions);
-
-        // access number of columns and infer DataType
-        int cols = sqlite3_column_count(stmt);
-        int column_type = 0;
-
-        String column_name;
+        }
 
-        for (int i = 5; i < cols ; ++i)
+        // workers: convert chunks of current window, the master joins after writing
+        if (w < n_windows)
         {
-          String column_name = sqlite3_column_name(stmt, i);
-          column_type = getColumnDatatype_(column_name);
-
-          if (sqlite3_column_type(stmt,i) == SQLITE_NULL)
-          {
-            break;
-          }
-          else if (column_type == DataValue::STRING_VALUE)
+#pragma omp for schedule(dynamic) nowait
+          for (SignedSize c = 0; c < static_cast<SignedSize>(window_size); ++c)
           {
-            String value;
-            column_name = column_name.substr(3);
-            Sql::extractValue<String>(&value, stmt, i);
-            dp.setMetaValue(column_name, value); 
-            continue;            
-          } 
-          else if (column_type == DataValue::INT_VALUE)
-          {
-            int value = 0;
-            column_name = column_name.substr(3);
-            Sql::extractValue<int>(&value, stmt, i);
-            dp.setMetaValue(column_name, value); 
-            continue;            
-          }
-          else if (column_type == DataValue::DOUBLE_VALUE)
-          {
-            double value = 0.0;
-            column_name = column_name.substr(3);
-            Sql::extractValue<double>(&value, stmt, i);          
-            dp.setMetaValue(column_name, value); 
-            continue;            
-          }
-          else if (column_type == DataValue::STRING_LIST)
-          {
-            String value; 
-            Sql::extractValue<String>(&value, stmt, i);
-            column_name = column_name.substr(4);
-            StringList sl;
-            // cut off "[" and "]""
-            value = value.chop(1);
-            value = value.substr(1);
-            value.split(", ", sl);
-            dp.setMetaValue(column_name, value); 
-            continue;            
-          }
-          else if (column_type == DataValue::INT_LIST)
-          {
-            String value; //IntList value;
-            Sql::extractValue<String>(&value, stmt, i); //IntList
-            column_name = column_name.substr(4);
-            value = value.chop(1);
-            value = value.substr(1);
-            vector<String> value_list;
-            IntList il = ListUtils::create<int>(value, ',');
-            dp.setMetaValue(column_name, value); 
-            continue;            
-          }
-          else if (column_type == DataValue::DOUBLE_LIST)
-          {
-            String value; //DoubleList value;
-            Sql::extractValue<String>(&value, stmt, i); //DoubleList
-            column_name = column_name.substr(4);
-            value = value.chop(1);
-            value = value.substr(1);          
-            DoubleList dl = ListUtils::create<double>(value, ',');
-            dp.setMetaValue(column_name, value); 
-            continue;            
-          }
-          else if (column_type == DataValue::EMPTY_VALUE)
-          {
-            String value;
-            column_name = column_name.substr(3);
-            Sql::extractValue<String>(&value, stmt, i);
-            dp.setMetaValue(column_name, value); 
-            continue;            
+            const Size chunk_begin = (w * window_size + c) * chunk_size;
+            const Size chunk_end = std::min(chunk_begin + chunk_size, feature_map.size());
+            for (Size i = chunk_begin; i < chunk_end; ++i)
+            {
+              const int64_t row_id = first_row_id < 0 ? -1 : first_row_id + static_cast<int64_t>(i);
+              addFeatureRows_(feature_map[i], feature_keys, subordinate_keys, sparse_keys, hull_points, row_id, buffers[w % 2][c]);
+            }
           }
         }
-
-        feature_map.getDataProcessing().push_back(dp);
-        sqlite3_step(stmt);
-
+#pragma omp barrier
       }
+    }
 
-      sqlite3_finalize(stmt);
+    if (!write_error.empty())
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, write_error);
+    }
+  }
 
-    } 
-    // end of dataprocessing ####################################
+  FeatureSQLFile::WriteOptions::WriteOptions() :
+    profile(DEFAULT_PROFILE),
+    index_core_columns(false),
+    indexed_meta_keys(),
+    string_dictionary(DICTIONARY_NEVER),
+    dense_meta_frequency(0.0),
+    hull_points(HULL_BOUNDINGBOX)
+  {
+  }
 
+  FeatureSQLFile::Summary::Summary() :
+    schema_version(0),
+    features(0),
+    subordinates(0),
+    feature_hulls(0),
+    subordinate_hulls(0),
+    dataprocessing(0),
+    region_index(false),
+    rt_min(0.0),
+    rt_max(0.0),
+    mz_min(0.0),
+    mz_max(0.0),
+    intensity_min(0.0),
+    intensity_max(0.0)
+  {
+  }
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+  //write FeatureMap as SQL database                                                      //
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+  
+  // fitted snippet of FeatureXMLFile::load
+  void FeatureSQLFile::write(const string& out_fm, const FeatureMap& feature_map, const WriteOptions& options) const
+  {
+    const String filename_ = out_fm;
     
-    
-    cout << "\n\nTest output after dataprocessing to correct for lacking entries" << endl; 
+    // delete file if present
+    File::remove(filename_);
 
+    //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //variable declaration                                                          //
+    //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////   
 
-    map<int64_t, size_t> map_fid_to_index; // map feature ids as indices in map 
+    // declare different table entries
+    // core columns of feature, subordinate and boundingbox tables
+    TableElements_ features_core = coreElements_("FEATURES_TABLE");
+    vector<String> feature_elements_ = features_core.names;
+    vector<String> feature_elements_types_ = features_core.types;
+    
+    TableElements_ subordinates_core = coreElements_("FEATURES_SUBORDINATES");
+    vector<String> subordinate_elements_ = subordinates_core.names;
+    vector<String> subordinate_elements_types_ = subordinates_core.types;
 
+    TableElements_ feat_bounding_box_elements_ = coreElements_("FEATURES_TABLE_BOUNDINGBOX");
+    TableElements_ sub_bounding_box_elements_ = coreElements_("SUBORDINATES_TABLE_BOUNDINGBOX");
 
-  ///* dataprocessing commenting 
+    // initialize tables
+    auto tables_ = getTables_(feature_map);
+    bool features_switch_ = get<0>(tables_);
+    bool subordinates_switch_ = get<1>(tables_);
+    bool features_bbox_switch_ = get<3>(tables_);
+    bool subordinates_bbox_switch_ = get<4>(tables_);
 
-    // begin features #############################################
+    // read values of (user)parameters of feature_map and store as key value map
+    // include all keys present in any feature (i.e. all CommonMetaKeys with frequency 0.0) in the map_key2type_
+    map<String, DataValue::DataType> map_key2type_ = metaKeyTypes_(feature_map, false);
+    // keys of few features are stored in FEATURES_SPARSE_META instead of a column
+    const map<String, DataValue::DataType> sparse_key2type_ = extractMetaKeys_(map_key2type_, rareMetaKeys_(feature_map, map_key2type_, options.dense_meta_frequency));
+    set<String> common_keys_;
+    for (const auto& key2type : map_key2type_)
+    {
+      common_keys_.insert(key2type.first);
+    }
+
+    // string keys stored as codes of the string dictionary
+    const set<String> feature_dictionary_keys_ = dictionaryKeys_(feature_map, map_key2type_, false, options.string_dictionary);
+
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// build feature header for sql table                                                            //                                      //
+    /// build subordinate header as sql table                                                         //                                      //
+    /// build boundingbox header as sql table                                                         //                                      //
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+        
+    // set feature header with dynamic part of user_parameters and respective entries of feature type
+    for (const String& key : common_keys_)
+    {
+      const PrefixSQLTypePair pSTP = columnPrefix_(map_key2type_[key], feature_dictionary_keys_.count(key) != 0);
+      // feature_elements_ vector with strings prefix (_TYPE_, _S_, _IL_, ...) and key  
+      feature_elements_.push_back(pSTP.prefix + key);
+      // feature_elements_ vector with SQL TYPES 
+      feature_elements_types_.push_back(pSTP.sqltype);
+    }
+
+    // prepare subordinate header
+    map<String, DataValue::DataType> subordinate_key2type_ = metaKeyTypes_(feature_map, true);
+    const set<String> subordinate_dictionary_keys_ = dictionaryKeys_(feature_map, subordinate_key2type_, true, options.string_dictionary);
+
+    // set subordinate header with dynamic part of user_parameters and respective entries of feature type
+    for (const auto& key2type : subordinate_key2type_)
+    {
+      const PrefixSQLTypePair pSTP = columnPrefix_(key2type.second, subordinate_dictionary_keys_.count(key2type.first) != 0);
+      // subordinate_elements_ vector with strings prefix (_TYPE_, _S_, _IL_, ...) and key  
+      subordinate_elements_.push_back(pSTP.prefix + key2type.first);
+      // subordinate_elements_type vector with SQL TYPES 
+      subordinate_elements_types_.push_back(pSTP.sqltype);
+    }
+
+
+    // boundingbox is part of convexhull is part of feature and subordinates
+    // points of MZ/RT-min-/maxima saved as quadrupel of doubles per convexhull number
+    // preparation of boundingbox header needs no further implementation of types at the moment
+
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    // create database with empty tables                                                //
+    // construct SQL_labels for feature, subordinate, dataprocessing and boundingbox tables
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    // create headers of tables by concatenation of elements and SQL types
+    // use single string with delimiter ',' as TABLE header
+    // distinguish first column (feature ID) as primary key
+
+    // 1. features table
+    String sql_stmt_features_ = tableDefinition_("FEATURES_TABLE", feature_elements_, feature_elements_types_);
+
+    // 2. subordinates table
+    String sql_stmt_subordinates_ = tableDefinition_("FEATURES_SUBORDINATES", subordinate_elements_, subordinate_elements_types_);
+
+    // 4. boundingbox table
+    // 4.1 features
+    String sql_stmt_feat_boundingbox = tableDefinition_("FEATURES_TABLE_BOUNDINGBOX", feat_bounding_box_elements_.names, feat_bounding_box_elements_.types);
+    // 4.2 subordinates
+    String sql_stmt_sub_boundingbox_ = tableDefinition_("SUBORDINATES_TABLE_BOUNDINGBOX", sub_bounding_box_elements_.names, sub_bounding_box_elements_.types);
+
+
+    // construct statements of the present tables, empty for tables without rows
+    String features_table_stmt_, subordinates_table_stmt_, feature_boundingbox_table_stmt_, subordinate_boundingbox_table_stmt_;
+    // 1. features
     if (features_switch_)
+    {
+      features_table_stmt_ = createTable_("FEATURES_TABLE", sql_stmt_features_);
+    }
+    // 2. subordinates
+    if (subordinates_switch_)
+    {
+      subordinates_table_stmt_ = createTable_("FEATURES_SUBORDINATES", sql_stmt_subordinates_);
+    }
+    // 4. boundingbox (features & subordinates)
+    if (features_bbox_switch_)
+    {
+      feature_boundingbox_table_stmt_ = createTable_("FEATURES_TABLE_BOUNDINGBOX", sql_stmt_feat_boundingbox);
+    }
+    if (subordinates_bbox_switch_)
+    {
+      subordinate_boundingbox_table_stmt_ = createTable_("SUBORDINATES_TABLE_BOUNDINGBOX", sql_stmt_sub_boundingbox_);
+    }
+
+    // contatenate table Strings
+    String create_sql_ = \
+      features_table_stmt_ + \
+      subordinates_table_stmt_ + \
+      feature_boundingbox_table_stmt_ + \
+      subordinate_boundingbox_table_stmt_ \
+      ;    
+
+    // Open connection to database, IN_MEMORY builds it in RAM and copies it to filename_ at the end
+    SqliteConnector conn(options.profile == IN_MEMORY ? String(":memory:") : filename_);
+    applyWriteProfile_(conn, options.profile);
+
+    // the whole file is written in a single transaction, rolled back if writing fails
+    SQLTransaction_ transaction(conn);
+    conn.executeStatement(create_sql_);
+
+    // spatial index of feature extents, used by readRegion
+    if (features_switch_)
+    {
+      createRegionIndex_(conn);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    // store FeatureMap data in table fields                                                          //
+    // 1. features                                                                                    //                                    
+    // 2. feature boundingboxes                                                                       //                                    
+    // 3. subordinates                                                                                //
+    // 4. subordinate boundingboxes                                                                   //
+    // 5. spatial index of feature extents                                                            //
+    // 6. dataprocessing                                                                              //
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    // every table gets a single prepared INSERT statement, rows are bound by position
+    // and the statement is reset after each row, so SQLite parses and plans it only once
+    sqlite3* db = conn.getDB();
+    const SparseKeys_ sparse_keys = addSparseKeys_(conn, sparse_key2type_);
+
+    SQLStatements_ statements;
+    prepareInserts_(db, statements, features_switch_ ? feature_elements_ : vector<String>(), subordinates_switch_ ? subordinate_elements_ : vector<String>(),
+                    features_bbox_switch_, subordinates_bbox_switch_);
+
+    // registry indices of the userparam columns in the order of the table headers
+    const vector<UInt> feature_keys = metaKeyIndices_(map_key2type_);
+    const vector<UInt> subordinate_keys = metaKeyIndices_(subordinate_key2type_);
+
+    // 1. - 5.
+    insertFeatures_(db, statements, feature_map, feature_keys, subordinate_keys, sparse_keys, options.hull_points);
+    statements.finalize();
+
+    // 6.
+    writeDataProcessing_(conn, feature_map);
+
+    createIndices_(conn, features_bbox_switch_, subordinates_switch_, subordinates_bbox_switch_);
+    if (features_switch_)
+    {
+      createFilterIndices_(conn, options, feature_elements_);
+    }
+    writeSummary_(conn, computeSummary_(db));
+    transaction.commit();
+
+    // flush in-memory database to disk in one go
+    if (options.profile == IN_MEMORY)
+    {
+      vacuumInto_(db, filename_);
+    }
+  } // end of FeatureSQLFile::write
+
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+  // append features to / update features of an existing database                                 //
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+
+  // storing helper function
+  // add the features of feature_map to the database of conn (see append()), within the caller's transaction;
+  // features of a multi-run file get run_id (negative: none)
+  void appendFeatures_(SqliteConnector& conn, const FeatureMap& feature_map, int64_t run_id = -1)
+  {
+    auto tables_ = getTables_(feature_map);
+    const bool features_switch_ = get<0>(tables_);
+    const bool subordinates_switch_ = get<1>(tables_);
+    const bool features_bbox_switch_ = get<3>(tables_);
+    const bool subordinates_bbox_switch_ = get<4>(tables_);
+    if (!features_switch_)
+    {
+      return;
+    }
+    sqlite3* db = conn.getDB();
+
+    // create tables not written before, e.g. on the first subordinates or convex hulls
+    createMissingTables_(conn, subordinates_switch_, features_bbox_switch_, subordinates_bbox_switch_);
+
+    // userparam columns, new meta keys are added to the tables
+    // keys stored in FEATURES_SPARSE_META before stay there
+    map<String, DataValue::DataType> feature_key2type = metaKeyTypes_(feature_map, false);
+    const SparseKeys_ sparse_keys = addSparseKeys_(conn, extractMetaKeys_(feature_key2type, sparseKeyNames_(db)));
+    vector<String> feature_elements = tableElements_(conn, "FEATURES_TABLE", feature_key2type);
+    const map<String, DataValue::DataType> subordinate_key2type = metaKeyTypes_(feature_map, true);
+    const vector<String> subordinate_elements = subordinates_switch_ ? tableElements_(conn, "FEATURES_SUBORDINATES", subordinate_key2type) : vector<String>();
+
+    // features of a run get consecutive row keys following those of the runs stored before
+    int64_t first_row_id = -1;
+    if (run_id >= 0)
+    {
+      feature_elements.push_back("FEATURE_ID");
+      sqlite3_stmt* stmt = nullptr;
+      SqliteConnector::prepareStatement(db, &stmt, "SELECT COALESCE(MAX(ID) + 1, 0) FROM FEATURES_TABLE;");
+      sqlite3_step(stmt);
+      first_row_id = sqlite3_column_int64(stmt, 0);
+      sqlite3_finalize(stmt);
+    }
+
+    SQLStatements_ statements;
+    prepareInserts_(db, statements, feature_elements, subordinate_elements, features_bbox_switch_, subordinates_bbox_switch_, run_id);
+    insertFeatures_(db, statements, feature_map, metaKeyIndices_(feature_key2type), metaKeyIndices_(subordinate_key2type), sparse_keys, storedHullPoints_(db),
+                    first_row_id);
+    statements.finalize();
+
+    createIndices_(conn, features_bbox_switch_, subordinates_switch_, subordinates_bbox_switch_);
+  }
+
+  void FeatureSQLFile::append(const string& in_featureSQL, const FeatureMap& feature_map) const
+  {
+    // opening would create an empty database
+    if (!File::exists(in_featureSQL))
+    {
+      throw Exception::FileNotFound(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, in_featureSQL);
+    }
+    if (feature_map.empty())
+    {
+      return;
+    }
+
+    SqliteConnector conn(in_featureSQL);
+    if (SqliteConnector::tableExists(conn.getDB(), "FEATURES_RUNS"))
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, in_featureSQL + " is a multi-run featureSQL file, features are added with writeRun().");
+    }
+    // all rows are appended or none, e.g. if a feature ID is already present
+    SQLTransaction_ transaction(conn);
+    const bool stored_summary = SqliteConnector::tableExists(conn.getDB(), "FEATURES_SUMMARY");
+    const Summary before = stored_summary ? readSummary_(conn.getDB()) : Summary();
+    appendFeatures_(conn, feature_map);
+    writeSummary_(conn, stored_summary ? extendedSummary_(conn.getDB(), before, feature_map, true) : computeSummary_(conn.getDB()));
+    transaction.commit();
+  }
+
+  Size FeatureSQLFile::writeRun(const string& in_featureSQL, const FeatureMap& feature_map) const
+  {
+    SqliteConnector conn(in_featureSQL);
+    sqlite3* db = conn.getDB();
+    // the run is added completely or not at all, e.g. if a feature ID occurs twice in the run
+    SQLTransaction_ transaction(conn);
+
+    if (!SqliteConnector::tableExists(db, "FEATURES_RUNS"))
+    {
+      if (SqliteConnector::tableExists(db, "FEATURES_TABLE"))
+      {
+        throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, in_featureSQL + " is a single-run featureSQL file, runs can only be added to files created by writeRun().");
+      }
+      createRunTables_(conn);
+    }
+    const bool stored_summary = SqliteConnector::tableExists(db, "FEATURES_SUMMARY");
+    const Summary before = stored_summary ? readSummary_(db) : Summary();
+
+    const int64_t run_id = addRun_(db, feature_map);
+    appendFeatures_(conn, feature_map, run_id);
+    writeRunDataProcessing_(conn, run_id, feature_map);
+    // indices of the runs, also if this one has no features
+    createIndices_(conn, false, false, false);
+    writeSummary_(conn, stored_summary ? extendedSummary_(db, before, feature_map, true) : computeSummary_(db));
+    transaction.commit();
+    return static_cast<Size>(run_id);
+  }
+
+  void FeatureSQLFile::update(const string& in_featureSQL, const FeatureMap& feature_map) const
+  {
+    // opening would create an empty database
+    if (!File::exists(in_featureSQL))
+    {
+      throw Exception::FileNotFound(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, in_featureSQL);
+    }
+    if (feature_map.empty())
+    {
+      return;
+    }
+
+    SqliteConnector conn(in_featureSQL);
+    sqlite3* db = conn.getDB();
+    // all features are updated or none, e.g. if a feature is not stored
+    SQLTransaction_ transaction(conn);
+    const bool stored_summary = SqliteConnector::tableExists(db, "FEATURES_SUMMARY");
+    const Summary before = stored_summary ? readSummary_(db) : Summary();
+
+    // userparam columns, new meta keys are added to the table; keys stored in FEATURES_SPARSE_META stay there
+    map<String, DataValue::DataType> key2type = metaKeyTypes_(feature_map, false);
+    const SparseKeys_ sparse_keys = addSparseKeys_(conn, extractMetaKeys_(key2type, sparseKeyNames_(db)));
+    const vector<String> meta_columns = addMetaColumns_(conn, "FEATURES_TABLE", key2type);
+
+    // parameters are numbered like the columns of featureRow_, ?1 is the ID
+    const vector<String> core_columns = coreElements_("FEATURES_TABLE").names;
+    vector<String> assignments;
+    for (Size idx = 1; idx != core_columns.size(); ++idx)
+    {
+      assignments.push_back(quoteIdentifier_(core_columns[idx]) + " = ?" + String(idx + 1));
+    }
+    for (Size idx = 0; idx != meta_columns.size(); ++idx)
+    {
+      assignments.push_back(quoteIdentifier_(meta_columns[idx]) + " = ?" + String(core_columns.size() + idx + 1));
+    }
+
+    SQLStatements_ statements;
+    // dictionary encoded columns keep their encoding, positions follow the core columns as in featureRow_
+    for (Size idx = 0; idx != meta_columns.size(); ++idx)
+    {
+      if (meta_columns[idx].hasPrefix("_SD_"))
+      {
+        statements.feature_dictionary_columns.push_back(core_columns.size() + idx);
+      }
+    }
+    if (!statements.feature_dictionary_columns.empty())
+    {
+      prepareDictionary_(db, statements);
+    }
+    SqliteConnector::prepareStatement(db, &statements.features, "UPDATE FEATURES_TABLE SET " + ListUtils::concatenate(assignments, ",") + " WHERE ID = ?1;");
+
+    // the extent of features without convex hulls is their position, which may have changed
+    if (SqliteConnector::tableExists(db, "FEATURES_REGION_INDEX"))
+    {
+      String update_index = "UPDATE FEATURES_REGION_INDEX SET min_RT = ?2, max_RT = ?2, min_MZ = ?3, max_MZ = ?3 WHERE ID = ?1";
+      if (SqliteConnector::tableExists(db, "FEATURES_TABLE_BOUNDINGBOX"))
+      {
+        update_index += " AND NOT EXISTS (SELECT 1 FROM FEATURES_TABLE_BOUNDINGBOX WHERE REF_ID = ?1)";
+      }
+      SqliteConnector::prepareStatement(db, &statements.region_index, update_index + ";");
+    }
+
+    // sparse values of the keys used in feature_map are replaced by those the feature has
+    if (!sparse_keys.empty())
+    {
+      vector<String> key_ids;
+      for (const auto& key : sparse_keys)
+      {
+        key_ids.push_back(String(static_cast<long long>(key.second)));
+      }
+      SqliteConnector::prepareStatement(db, &statements.sparse_meta_delete,
+        "DELETE FROM FEATURES_SPARSE_META WHERE REF_ID = ?1 AND KEY_ID IN (" + ListUtils::concatenate(key_ids, ",") + ");");
+      SqliteConnector::prepareStatement(db, &statements.sparse_meta, "INSERT INTO FEATURES_SPARSE_META (REF_ID, KEY_ID, VALUE) VALUES (?,?,?);");
+    }
+
+    // features of multi-run files are stored by row key, their unique ID has to be stored for a single run
+    if (SqliteConnector::columnExists(db, "FEATURES_TABLE", "FEATURE_ID"))
+    {
+      SqliteConnector::prepareStatement(db, &statements.row_key, "SELECT ID FROM FEATURES_TABLE WHERE FEATURE_ID = ? LIMIT 2;");
+    }
+
+    const vector<UInt> feature_keys = metaKeyIndices_(key2type);
+    for (const Feature& feature : feature_map)
+    {
+      int64_t id = static_cast<int64_t>(feature.getUniqueId() & ~(1ULL << 63));
+      if (statements.row_key != nullptr)
+      {
+        checkBind_(db, sqlite3_bind_int64(statements.row_key, 1, id));
+        // not stored: no row has key -1, so the update below changes nothing
+        id = sqlite3_step(statements.row_key) == SQLITE_ROW ? sqlite3_column_int64(statements.row_key, 0) : -1;
+        if (id >= 0 && sqlite3_step(statements.row_key) == SQLITE_ROW)
+        {
+          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+            "Feature with unique ID " + String(feature.getUniqueId()) + " is stored for several runs of " + in_featureSQL + ".");
+        }
+        sqlite3_reset(statements.row_key);
+      }
+      vector<SQLRow_> rows(1, featureRow_(feature, feature_keys, id));
+      encodeStrings_(db, statements, statements.feature_dictionary_columns, rows);
+      const SQLRow_& row = rows[0];
+      insertRows_(db, statements.features, rows);
+      if (sqlite3_changes(db) == 0)
+      {
+        throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+          "Feature with unique ID " + String(feature.getUniqueId()) + " is not stored in " + in_featureSQL + ".");
+      }
+      if (statements.region_index != nullptr)
+      {
+        insertRows_(db, statements.region_index, vector<SQLRow_>(1, SQLRow_(row.begin(), row.begin() + 3)));
+      }
+      if (statements.sparse_meta != nullptr)
+      {
+        insertRows_(db, statements.sparse_meta_delete, vector<SQLRow_>(1, SQLRow_(row.begin(), row.begin() + 1)));
+        vector<SQLRow_> sparse_rows;
+        addSparseRows_(feature, id, sparse_keys, sparse_rows);
+        insertRows_(db, statements.sparse_meta, sparse_rows);
+      }
+    }
+    statements.finalize();
+
+    writeSummary_(conn, stored_summary ? extendedSummary_(db, before, feature_map, false) : computeSummary_(db));
+    transaction.commit();
+  }
+
+  FeatureSQLFile::Summary FeatureSQLFile::stat(const string& in_featureSQL) const
+  {
+    if (!File::exists(in_featureSQL))
+    {
+      throw Exception::FileNotFound(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, in_featureSQL);
+    }
+    SqliteConnector conn(in_featureSQL);
+    sqlite3* db = conn.getDB();
+
+    return readSummary_(db);
+  }
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+  // streaming writer                                                                               //
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+
+  // state of an open Writer, members are destroyed in reverse order:
+  // statements are finalized before an uncommitted transaction is rolled back and the connection is closed
+  struct FeatureSQLFile::Writer::Impl
+  {
+    Impl(const String& filename, const WriteOptions& options) :
+      filename(filename),
+      options(options),
+      conn(options.profile == IN_MEMORY ? String(":memory:") : filename)
+    {
+      applyWriteProfile_(conn, options.profile);
+      transaction.reset(new SQLTransaction_(conn));
+    }
+
+    // add meta keys, subordinates and convex hulls of feature to the schema, true if it changed
+    bool addToSchema(const Feature& feature)
+    {
+      bool changed = false;
+      feature.getKeys(meta_indices);
+      for (UInt index : meta_indices)
+      {
+        if (feature_indices.insert(index).second)
+        {
+          const String key = MetaInfoInterface::metaRegistry().getName(index);
+          const bool sparse = options.dense_meta_frequency > 0.0 && dense_keys.count(key) == 0;
+          (sparse ? sparse_key2type : feature_key2type)[key] = feature.getMetaValue(index).valueType();
+          changed = true;
+        }
+      }
+      if (!features_bbox && !feature.getConvexHulls().empty())
+      {
+        features_bbox = changed = true;
+      }
+      for (const Feature& subordinate : feature.getSubordinates())
+      {
+        if (!subordinates)
+        {
+          subordinates = changed = true;
+        }
+        if (!subordinates_bbox && !subordinate.getConvexHulls().empty())
+        {
+          subordinates_bbox = changed = true;
+        }
+        subordinate.getKeys(meta_indices);
+        for (UInt index : meta_indices)
+        {
+          if (subordinate_indices.insert(index).second)
+          {
+            subordinate_key2type[MetaInfoInterface::metaRegistry().getName(index)] = subordinate.getMetaValue(index).valueType();
+            changed = true;
+          }
+        }
+      }
+      return changed;
+    }
+
+    // create missing tables and columns and prepare the INSERT statements for the current schema
+    void applySchema()
+    {
+      statements.finalize();
+      createMissingTables_(conn, subordinates, features_bbox, subordinates_bbox);
+      sparse_keys = addSparseKeys_(conn, sparse_key2type);
+      // distinct values are unknown in advance, DICTIONARY_AUTO stores plain text
+      const DictionaryEncoding encoding = options.string_dictionary == DICTIONARY_ALWAYS ? DICTIONARY_ALWAYS : DICTIONARY_NEVER;
+      feature_elements = tableElements_(conn, "FEATURES_TABLE", feature_key2type, dictionaryKeys_(FeatureMap(), feature_key2type, false, encoding));
+      const vector<String> subordinate_elements = subordinates ? tableElements_(conn, "FEATURES_SUBORDINATES", subordinate_key2type,
+                                                                                dictionaryKeys_(FeatureMap(), subordinate_key2type, true, encoding)) : vector<String>();
+      prepareInserts_(conn.getDB(), statements, feature_elements, subordinate_elements, features_bbox, subordinates_bbox);
+      feature_keys = metaKeyIndices_(feature_key2type);
+      subordinate_keys = metaKeyIndices_(subordinate_key2type);
+    }
+
+    void flush()
+    {
+      insertBatch_(conn.getDB(), statements, batch);
+      batch = SQLBatch_();
+    }
+
+    String filename;
+    WriteOptions options;
+    FeatureMap map_info; // unique ID and dataprocessing entries
+    SqliteConnector conn;
+    std::unique_ptr<SQLTransaction_> transaction;
+    SQLStatements_ statements;
+    SQLBatch_ batch;
+
+    bool subordinates = false;
+    bool features_bbox = false;
+    bool subordinates_bbox = false;
+    map<String, DataValue::DataType> feature_key2type;
+    map<String, DataValue::DataType> subordinate_key2type;
+    map<String, DataValue::DataType> sparse_key2type;
+    set<String> dense_keys; // feature meta keys stored as columns if WriteOptions::dense_meta_frequency is positive
+    set<UInt> feature_indices;
+    set<UInt> subordinate_indices;
+    vector<UInt> meta_indices;
+    vector<String> feature_elements;
+    vector<UInt> feature_keys;
+    vector<UInt> subordinate_keys;
+    SparseKeys_ sparse_keys;
+  };
+
+  FeatureSQLFile::Writer::Writer() :
+    impl_()
+  {
+  }
+
+  FeatureSQLFile::Writer::~Writer()
+  {
+  }
+
+  void FeatureSQLFile::Writer::open(const string& out_fm, const FeatureMap& schema, const WriteOptions& options)
+  {
+    if (impl_)
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "FeatureSQLFile::Writer is already open.");
+    }
+    const String filename = out_fm;
+    File::remove(filename);
+
+    std::unique_ptr<Impl> impl(new Impl(filename, options));
+    impl->map_info.setUniqueId(schema.getUniqueId());
+    impl->map_info.setDataProcessing(schema.getDataProcessing());
+    // keys of few features of the schema and keys not in the schema are stored in FEATURES_SPARSE_META
+    if (options.dense_meta_frequency > 0.0)
+    {
+      map<String, DataValue::DataType> schema_key2type = metaKeyTypes_(schema, false);
+      extractMetaKeys_(schema_key2type, rareMetaKeys_(schema, schema_key2type, options.dense_meta_frequency));
+      for (const auto& k2t : schema_key2type)
+      {
+        impl->dense_keys.insert(k2t.first);
+      }
+    }
+    for (const Feature& feature : schema)
+    {
+      impl->addToSchema(feature);
+    }
+    impl->applySchema();
+    impl_ = std::move(impl);
+  }
+
+  void FeatureSQLFile::Writer::consume(const Feature& feature)
+  {
+    // rows are flushed in batches of this many features
+    const Size batch_size = 4096;
+
+    if (!impl_)
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "FeatureSQLFile::Writer is not open.");
+    }
+    if (impl_->addToSchema(feature))
+    {
+      // buffered rows match the previous statements
+      impl_->flush();
+      impl_->applySchema();
+    }
+    addFeatureRows_(feature, impl_->feature_keys, impl_->subordinate_keys, impl_->sparse_keys, impl_->options.hull_points, -1, impl_->batch);
+    if (impl_->batch.features.size() >= batch_size)
+    {
+      impl_->flush();
+    }
+  }
+
+  void FeatureSQLFile::Writer::close()
+  {
+    if (!impl_)
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "FeatureSQLFile::Writer is not open.");
+    }
+    // the writer is closed even if storing fails (and the transaction is rolled back)
+    std::unique_ptr<Impl> impl = std::move(impl_);
+    impl->flush();
+    impl->statements.finalize();
+
+    writeDataProcessing_(impl->conn, impl->map_info);
+    createIndices_(impl->conn, impl->features_bbox, impl->subordinates, impl->subordinates_bbox);
+    createFilterIndices_(impl->conn, impl->options, impl->feature_elements);
+    writeSummary_(impl->conn, computeSummary_(impl->conn.getDB()));
+    impl->transaction->commit();
+
+    if (impl->options.profile == IN_MEMORY)
+    {
+      vacuumInto_(impl->conn.getDB(), impl->filename);
+    }
+  }
+
+  FeatureSQLFile::ReadOptions::ReadOptions() :
+    all_meta_values(true),
+    meta_keys(),
+    subordinates(true),
+    convex_hulls(true),
+    dataprocessing(true),
+    immutable(false),
+    intensity_min(-numeric_limits<double>::max()),
+    intensity_max(numeric_limits<double>::max()),
+    quality_min(-numeric_limits<double>::max()),
+    quality_max(numeric_limits<double>::max()),
+    charge_min(numeric_limits<Int>::min()),
+    charge_max(numeric_limits<Int>::max()),
+    meta_values()
+  {
+  }
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+  // read function                                                                                  //
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+  // read BBox values of convex hull entries for feature, subordinate table
+  // points: the encoded hull points follow max_RT, the hull is restored from them unless NULL
+  ConvexHull2D readBBox_(sqlite3_stmt* stmt, int column_nr, bool points = false)
+  {
+    ConvexHull2D hull;
+    if (points && sqlite3_column_type(stmt, column_nr + 5) == SQLITE_BLOB)
+    {
+      hull.setHullPoints(fromSQLHullPoints_(static_cast<const unsigned char*>(sqlite3_column_blob(stmt, column_nr + 5)), sqlite3_column_bytes(stmt, column_nr + 5)));
+      return hull;
+    }
+
+    double min_MZ = 0.0;
+    Sql::extractValue<double>(&min_MZ, stmt, (column_nr + 1));
+    double min_RT = 0.0;
+    Sql::extractValue<double>(&min_RT, stmt, (column_nr + 2));
+    double max_MZ = 0.0;
+    Sql::extractValue<double>(&max_MZ, stmt, (column_nr + 3));
+    double max_RT = 0.0;
+    Sql::extractValue<double>(&max_RT, stmt, (column_nr + 4));
+
+    hull.addPoint({min_MZ, min_RT});
+    hull.addPoint({max_MZ, max_RT});
+    return hull;
+  }
+
+  // get values of subordinate and its user parameters from current row of the subordinate cursor
+  // columns: REF_ID, ID, RT, MZ, Intensity, Charge, Quality, userparams decoded by plan
+  Feature readSubordinate_(sqlite3_stmt* stmt, const DecoderPlan_& plan)
+  {
+    Feature subordinate;
+
+    int64_t id_sub = sqlite3_column_int64(stmt, 1);
+
+    double rt = 0.0;
+    Sql::extractValue<double>(&rt, stmt, 2);
+    double mz = 0.0;
+    Sql::extractValue<double>(&mz, stmt, 3);
+    double intensity = 0.0;
+    Sql::extractValue<double>(&intensity, stmt, 4);
+    int charge = 0;
+    Sql::extractValue<int>(&charge, stmt, 5);
+    double quality = 0.0;
+    Sql::extractValue<double>(&quality, stmt, 6);
+    subordinate.setUniqueId(id_sub);
+    subordinate.setRT(rt);
+    subordinate.setMZ(mz);
+    subordinate.setIntensity(intensity);
+    subordinate.setCharge(charge);
+    subordinate.setOverallQuality(quality);
+
+    // userparams
+    decodeUserParams_(subordinate, stmt, plan);
+    return subordinate;
+  }
+
+  // reading helper function
+  // qualified result columns for the userparam columns of table requested by options
+  // columns are aliased with their stored name, which holds the DataValue type prefix needed by compileDecoders_
+  vector<String> selectMetaColumns_(sqlite3* db, const String& table, const FeatureSQLFile::ReadOptions& options)
+  {
+    vector<String> columns;
+    for (const String& name : getColumnNames_(db, table))
+    {
+      if (getColumnDatatype_(name) == DataValue::EMPTY_VALUE) // core column without type prefix
+      {
+        continue;
+      }
+      // key follows the type prefix (_S_, _IL_, ...)
+      const String key = name.substr(name.find('_', 1) + 1);
+      if (options.all_meta_values || options.meta_keys.count(key) != 0)
+      {
+        columns.push_back(table + "." + quoteIdentifier_(name) + " AS " + quoteIdentifier_(name));
+      }
+    }
+    return columns;
+  }
+
+  // reading helper function
+  // comma separated list of columns of table
+  String qualifiedColumns_(const String& table, const vector<String>& columns)
+  {
+    vector<String> qualified;
+    for (const String& column : columns)
+    {
+      qualified.push_back(table + "." + column);
+    }
+    return ListUtils::concatenate(qualified, ", ");
+  }
+
+  // reading helper function
+  // column of FEATURES_TABLE holding the unique IDs: FEATURE_ID in multi-run files, where ID is a row key, ID otherwise
+  String featureIdColumn_(sqlite3* db)
+  {
+    return SqliteConnector::columnExists(db, "FEATURES_TABLE", "FEATURE_ID") ? "FEATURE_ID" : "ID";
+  }
+
+  // reading helper function
+  // SQL literal of a value, doubles with round trip precision
+  String sqlLiteral_(const SQLValue_& value)
+  {
+    switch (value.type)
+    {
+      case SQLValue_::INT_TYPE:
+        return String(static_cast<long long>(value.int_value));
+      case SQLValue_::REAL_TYPE:
+      {
+        std::ostringstream literal;
+        literal.precision(17);
+        literal << value.real_value;
+        return literal.str();
+      }
+      case SQLValue_::TEXT_TYPE:
+      {
+        char* quoted = sqlite3_mprintf("%Q", value.text_value.c_str());
+        const String literal = quoted;
+        sqlite3_free(quoted);
+        return literal;
+      }
+      case SQLValue_::BLOB_TYPE:
+      {
+        static const char hex[] = "0123456789ABCDEF";
+        String literal = "X'";
+        for (unsigned char byte : value.text_value)
+        {
+          literal.push_back(hex[byte >> 4]);
+          literal.push_back(hex[byte & 0x0F]);
+        }
+        return literal + "'";
+      }
+      case SQLValue_::NULL_TYPE:
+        break;
+    }
+    return "NULL";
+  }
+
+  // reading helper function
+  // values of FEATURES_STRING_DICTIONARY by code, each distinct string is constructed once per read
+  vector<DataValue> readStringDictionary_(sqlite3* db)
+  {
+    vector<DataValue> dictionary;
+    if (!SqliteConnector::tableExists(db, "FEATURES_STRING_DICTIONARY"))
+    {
+      return dictionary;
+    }
+    sqlite3_stmt* stmt = nullptr;
+    SqliteConnector::prepareStatement(db, &stmt, "SELECT CODE, VALUE FROM FEATURES_STRING_DICTIONARY ORDER BY CODE;");
+    while (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+      // codes are assigned consecutively from 0
+      const Size code = static_cast<Size>(sqlite3_column_int64(stmt, 0));
+      dictionary.resize(std::max(dictionary.size(), code + 1));
+      dictionary[code] = DataValue(String(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)), sqlite3_column_bytes(stmt, 1)));
+    }
+    sqlite3_finalize(stmt);
+    return dictionary;
+  }
+
+  // reading helper function
+  // SQL condition on FEATURES_TABLE for the feature filters of options, empty if nothing is filtered
+  String featurePredicate_(sqlite3* db, const FeatureSQLFile::ReadOptions& options)
+  {
+    vector<String> conditions;
+    auto add_bounds = [&conditions](const String& column, double min, double max, double lowest, double highest)
+    {
+      if (min > lowest)
+      {
+        conditions.push_back("FEATURES_TABLE." + column + " >= " + sqlLiteral_(SQLValue_(min)));
+      }
+      if (max < highest)
+      {
+        conditions.push_back("FEATURES_TABLE." + column + " <= " + sqlLiteral_(SQLValue_(max)));
+      }
+    };
+    add_bounds("Intensity", options.intensity_min, options.intensity_max, -numeric_limits<double>::max(), numeric_limits<double>::max());
+    add_bounds("Quality", options.quality_min, options.quality_max, -numeric_limits<double>::max(), numeric_limits<double>::max());
+    if (options.charge_min > numeric_limits<Int>::min())
+    {
+      conditions.push_back("FEATURES_TABLE.Charge >= " + String(options.charge_min));
+    }
+    if (options.charge_max < numeric_limits<Int>::max())
+    {
+      conditions.push_back("FEATURES_TABLE.Charge <= " + String(options.charge_max));
+    }
+
+    if (!options.meta_values.empty())
+    {
+      const vector<String> names = getColumnNames_(db, "FEATURES_TABLE");
+      const set<String> stored(names.begin(), names.end());
+      const map<String, pair<int64_t, DataValue::DataType> > sparse_keys = storedSparseKeys_(db);
+      for (const auto& key2value : options.meta_values)
+      {
+        if (key2value.second.isEmpty())
+        {
+          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Empty filter value for meta key '" + key2value.first + "'.");
+        }
+        // values are compared in the column of their type, no feature matches if it is not stored
+        const String column = enumToPrefix_(key2value.second.valueType()).prefix + key2value.first;
+        const String literal = sqlLiteral_(toSQLValue_(key2value.second));
+        if (stored.count(column) != 0)
+        {
+          conditions.push_back("FEATURES_TABLE." + quoteIdentifier_(column) + " = " + literal);
+        }
+        else if (key2value.second.valueType() == DataValue::STRING_VALUE && stored.count("_SD_" + key2value.first) != 0)
+        {
+          // dictionary encoded strings are compared by their code
+          conditions.push_back("FEATURES_TABLE." + quoteIdentifier_("_SD_" + key2value.first) + " = (SELECT CODE FROM FEATURES_STRING_DICTIONARY WHERE VALUE = " + literal + ")");
+        }
+        else if (sparse_keys.count(key2value.first) != 0 && sparse_keys.at(key2value.first).second == key2value.second.valueType())
+        {
+          conditions.push_back("EXISTS (SELECT 1 FROM FEATURES_SPARSE_META WHERE FEATURES_SPARSE_META.REF_ID = FEATURES_TABLE.ID AND FEATURES_SPARSE_META.KEY_ID = " +
+                               String(static_cast<long long>(sparse_keys.at(key2value.first).first)) + " AND FEATURES_SPARSE_META.VALUE = " + literal + ")");
+        }
+        else
+        {
+          return "0";
+        }
+      }
+    }
+    return ListUtils::concatenate(conditions, " AND ");
+  }
+
+  // reading helper
+  // SQL condition restricting the features read, given the column holding the feature ID (ID or REF_ID)
+  // of the queried table; an empty function reads all features
+  typedef std::function<String(const String& id_column)> IDFilter_;
+
+  // reading helper
+  // result rows of a query ordered by feature ID, advanced in lockstep with the feature cursor
+  struct SQLCursor_
+  {
+    SQLCursor_() = default;
+    SQLCursor_(const SQLCursor_&) = delete;
+    SQLCursor_& operator=(const SQLCursor_&) = delete;
+
+    ~SQLCursor_()
+    {
+      sqlite3_finalize(stmt); // no-op on nullptr
+    }
+
+    void open(sqlite3* db, const String& sql)
+    {
+      SqliteConnector::prepareStatement(db, &stmt, sql);
+      next();
+    }
+
+    void next()
+    {
+      rc = sqlite3_step(stmt);
+      if (rc != SQLITE_ROW && rc != SQLITE_DONE)
+      {
+        throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Error reading featureSQL file: " + String(sqlite3_errmsg(sqlite3_db_handle(stmt))));
+      }
+    }
+
+    bool valid() const
+    {
+      return rc == SQLITE_ROW;
+    }
+
+    // skip rows of features preceding f_id, true if the current row belongs to feature f_id
+    bool seek(int64_t f_id)
+    {
+      while (valid() && sqlite3_column_int64(stmt, 0) < f_id)
+      {
+        next();
+      }
+      return valid() && sqlite3_column_int64(stmt, 0) == f_id;
+    }
+
+    sqlite3_stmt* stmt = nullptr;
+    int rc = SQLITE_DONE;
+  };
+
+  // reading helper
+  // connection of the readers: a SqliteConnector, or for ReadOptions::immutable a read-only connection
+  // to the file opened as immutable (no locking, no change detection) with the whole file memory mapped
+  class ReadConnection_
+  {
+  public:
+    ReadConnection_(const String& filename, bool immutable)
+    {
+      if (!immutable)
+      {
+        connector_.reset(new SqliteConnector(filename));
+        db_ = connector_->getDB();
+        return;
+      }
+
+      // a missing file would fail on the first query only
+      if (!File::exists(filename))
+      {
+        throw Exception::FileNotFound(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+      }
+      // characters with a meaning in URIs are percent-encoded
+      String uri = "file:";
+      for (char c : filename)
+      {
+        if (c == '%' || c == '?' || c == '#')
+        {
+          char encoded[4];
+          snprintf(encoded, sizeof(encoded), "%%%02X", static_cast<unsigned char>(c));
+          uri += encoded;
+        }
+        else
+        {
+          uri.push_back(c);
+        }
+      }
+      uri += "?mode=ro&immutable=1";
+      if (sqlite3_open_v2(uri.c_str(), &db_, SQLITE_OPEN_READONLY | SQLITE_OPEN_URI, nullptr) != SQLITE_OK)
+      {
+        const String error = sqlite3_errmsg(db_);
+        sqlite3_close(db_);
+        throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Error opening " + filename + ": " + error);
+      }
+      // pages are read from the mapping instead of being copied (capped by SQLITE_MAX_MMAP_SIZE of the SQLite build)
+      std::ifstream in(filename.c_str(), std::ios::binary | std::ios::ate);
+      SqliteConnector::executeStatement(db_, "PRAGMA mmap_size = " + String(static_cast<long long>(in.tellg())) + ";");
+    }
+
+    ~ReadConnection_()
+    {
+      if (!connector_)
+      {
+        sqlite3_close(db_);
+      }
+    }
+
+    ReadConnection_(const ReadConnection_&) = delete;
+    ReadConnection_& operator=(const ReadConnection_&) = delete;
+
+    sqlite3* getDB()
+    {
+      return db_;
+    }
+
+    void executeStatement(const String& statement)
+    {
+      SqliteConnector::executeStatement(db_, statement);
+    }
+
+  private:
+    std::unique_ptr<SqliteConnector> connector_;
+    sqlite3* db_ = nullptr;
+  };
+
+  // reconstruct features of database one by one and hand each to consumer
+  // every table is read by its own cursor ordered by feature ID (REF_ID of the dependent tables),
+  // the cursors are merged in a single pass, so feature rows are neither joined nor repeated
+  // and only the current feature is held in memory
+  // only the columns and tables requested by options are queried
+  // id_filter: optional restriction of the features read
+  void streamFeatures_(sqlite3* db, const FeatureSQLFile::FeatureConsumer& consumer, const FeatureSQLFile::ReadOptions& options, const IDFilter_& id_filter = IDFilter_())
+  {
+    // set switches to access only existent and requested tables
+    bool features_switch_ = SqliteConnector::tableExists(db, "FEATURES_TABLE");
+    bool subordinates_switch_ = options.subordinates && SqliteConnector::tableExists(db, "FEATURES_SUBORDINATES");
+    bool features_bbox_switch_ = options.convex_hulls && SqliteConnector::tableExists(db, "FEATURES_TABLE_BOUNDINGBOX");
+    bool subordinates_bbox_switch_ = subordinates_switch_ && options.convex_hulls && SqliteConnector::tableExists(db, "SUBORDINATES_TABLE_BOUNDINGBOX");
+
+    if (!features_switch_)
+    {
+      return;
+    }
+
+    // filters of options are applied to the features and, by their IDs, to the dependent tables
+    const String predicate = featurePredicate_(db, options);
+    auto where_sql = [&id_filter, &predicate](const String& id_column)
+    {
+      vector<String> conditions;
+      if (id_filter)
+      {
+        conditions.push_back(id_filter(id_column));
+      }
+      if (!predicate.empty())
+      {
+        conditions.push_back(id_column == "FEATURES_TABLE.ID" ? predicate : id_column + " IN (SELECT FEATURES_TABLE.ID FROM FEATURES_TABLE WHERE " + predicate + ")");
+      }
+      return conditions.empty() ? String() : String(" WHERE ") + ListUtils::concatenate(conditions, " AND ");
+    };
+
+    //////////////////////////////////////////////////////////////////////////////////////////
+    // one query per present and requested table
+    // 1. features: ID, RT, MZ, Intensity, Charge, Quality, userparams
+    // 2. feature boundingboxes: REF_ID, min_MZ, min_RT, max_MZ, max_RT(, POINTS)
+    // 3. subordinates: REF_ID, ID, RT, MZ, Intensity, Charge, Quality, userparams
+    // 4. subordinate boundingboxes: REF_ID, ID, min_MZ, min_RT, max_MZ, max_RT(, POINTS)
+    // 5. sparse meta values of features: REF_ID, KEY_ID, VALUE
+    //////////////////////////////////////////////////////////////////////////////////////////
+    const vector<String> bbox_columns = {"min_MZ", "min_RT", "max_MZ", "max_RT"};
+    // hull points are queried if the file can hold them
+    const bool feature_points = features_bbox_switch_ && SqliteConnector::columnExists(db, "FEATURES_TABLE_BOUNDINGBOX", "POINTS");
+    const bool subordinate_points = subordinates_bbox_switch_ && SqliteConnector::columnExists(db, "SUBORDINATES_TABLE_BOUNDINGBOX", "POINTS");
+
+    // shared by the plans of features and subordinates
+    const vector<DataValue> dictionary = readStringDictionary_(db);
+
+    vector<String> feature_columns = {qualifiedColumns_("FEATURES_TABLE", {"ID", "RT", "MZ", "Intensity", "Charge", "Quality"})};
+    const vector<String> feature_meta_columns = selectMetaColumns_(db, "FEATURES_TABLE", options);
+    feature_columns.insert(feature_columns.end(), feature_meta_columns.begin(), feature_meta_columns.end());
+    // features of multi-run files are merged by row key (ID), their unique ID follows the userparams
+    const bool row_keys = SqliteConnector::columnExists(db, "FEATURES_TABLE", "FEATURE_ID");
+    if (row_keys)
+    {
+      feature_columns.push_back("FEATURES_TABLE.FEATURE_ID");
+    }
+
+    SQLCursor_ features;
+    features.open(db, "SELECT " + ListUtils::concatenate(feature_columns, ", ") + " FROM FEATURES_TABLE" + where_sql("FEATURES_TABLE.ID") + " ORDER BY FEATURES_TABLE.ID;");
+    // type and meta key of userparam columns are resolved once per query
+    const int n_feature_columns = sqlite3_column_count(features.stmt) - (row_keys ? 1 : 0);
+    const DecoderPlan_ feature_plan = compileDecoders_(features.stmt, 6, n_feature_columns, &dictionary);
+
+    // meta values of features in FEATURES_SPARSE_META, decoded by the type of their key
+    SQLCursor_ sparse_meta;
+    unordered_map<int64_t, ColumnDecoder_> sparse_decoders;
+    for (const auto& sparse_key : storedSparseKeys_(db))
+    {
+      if (options.all_meta_values || options.meta_keys.count(sparse_key.first) != 0)
+      {
+        sparse_decoders[sparse_key.second.first] = {2, MetaInfoInterface::metaRegistry().registerName(sparse_key.first), sparse_key.second.second, nullptr};
+      }
+    }
+    if (!sparse_decoders.empty())
+    {
+      sparse_meta.open(db, "SELECT " + qualifiedColumns_("FEATURES_SPARSE_META", {"REF_ID", "KEY_ID", "VALUE"}) + " FROM FEATURES_SPARSE_META" +
+                           where_sql("FEATURES_SPARSE_META.REF_ID") + " ORDER BY FEATURES_SPARSE_META.REF_ID, FEATURES_SPARSE_META.KEY_ID;");
+    }
+
+    SQLCursor_ feature_bboxes;
+    if (features_bbox_switch_)
+    {
+      feature_bboxes.open(db, "SELECT " + qualifiedColumns_("FEATURES_TABLE_BOUNDINGBOX", {"REF_ID"}) + ", " + qualifiedColumns_("FEATURES_TABLE_BOUNDINGBOX", bbox_columns) +
+                              (feature_points ? ", FEATURES_TABLE_BOUNDINGBOX.POINTS" : "") + " FROM FEATURES_TABLE_BOUNDINGBOX" + where_sql("FEATURES_TABLE_BOUNDINGBOX.REF_ID") +
+                              " ORDER BY FEATURES_TABLE_BOUNDINGBOX.REF_ID, FEATURES_TABLE_BOUNDINGBOX.BB_IDX;");
+    }
+
+    SQLCursor_ subordinates;
+    DecoderPlan_ subordinate_plan;
+    if (subordinates_switch_)
+    {
+      vector<String> subordinate_columns = {qualifiedColumns_("FEATURES_SUBORDINATES", {"REF_ID", "ID", "RT", "MZ", "Intensity", "Charge", "Quality"})};
+      const vector<String> subordinate_meta_columns = selectMetaColumns_(db, "FEATURES_SUBORDINATES", options);
+      subordinate_columns.insert(subordinate_columns.end(), subordinate_meta_columns.begin(), subordinate_meta_columns.end());
+      subordinates.open(db, "SELECT " + ListUtils::concatenate(subordinate_columns, ", ") + " FROM FEATURES_SUBORDINATES" + where_sql("FEATURES_SUBORDINATES.REF_ID") +
+                            " ORDER BY FEATURES_SUBORDINATES.REF_ID, FEATURES_SUBORDINATES.SUB_IDX;");
+      subordinate_plan = compileDecoders_(subordinates.stmt, 7, sqlite3_column_count(subordinates.stmt), &dictionary);
+    }
+
+    // boundingboxes of subordinates are grouped by feature, within a feature they are assigned by subordinate position (SUB_IDX);
+    // rows written without SUB_IDX (NULL) are assigned by subordinate ID
+    SQLCursor_ subordinate_bboxes;
+    if (subordinates_bbox_switch_)
+    {
+      const String sub_idx_column = SqliteConnector::columnExists(db, "SUBORDINATES_TABLE_BOUNDINGBOX", "SUB_IDX") ? "SUBORDINATES_TABLE_BOUNDINGBOX.SUB_IDX" : "NULL";
+      subordinate_bboxes.open(db, "SELECT " + qualifiedColumns_("SUBORDINATES_TABLE_BOUNDINGBOX", {"REF_ID", "ID"}) + ", " + sub_idx_column + ", " + qualifiedColumns_("SUBORDINATES_TABLE_BOUNDINGBOX", bbox_columns) +
+                                  (subordinate_points ? ", SUBORDINATES_TABLE_BOUNDINGBOX.POINTS" : "") + " FROM SUBORDINATES_TABLE_BOUNDINGBOX" + where_sql("SUBORDINATES_TABLE_BOUNDINGBOX.REF_ID") +
+                                  " ORDER BY SUBORDINATES_TABLE_BOUNDINGBOX.REF_ID, " + sub_idx_column + ", SUBORDINATES_TABLE_BOUNDINGBOX.ID, SUBORDINATES_TABLE_BOUNDINGBOX.BB_IDX;");
+    }
+
+    // position of each subordinate ID within the current feature, for rows without SUB_IDX
+    unordered_map<int64_t, Size> map_sid_to_index;
+
+    for (; features.valid(); features.next())
+    {
+      Feature feature;
+
+      // return value of feature ID (row key) in column #0
+      int64_t f_id = sqlite3_column_int64(features.stmt, 0);
+
+      // get values id, RT, MZ, Intensity, Charge, Quality
+      double rt = 0.0;
+      Sql::extractValue<double>(&rt, features.stmt, 1);
+      double mz = 0.0;
+      Sql::extractValue<double>(&mz, features.stmt, 2);
+      double intensity = 0.0;
+      Sql::extractValue<double>(&intensity, features.stmt, 3);
+      int charge = 0;
+      Sql::extractValue<int>(&charge, features.stmt, 4);
+      double quality = 0.0;
+      Sql::extractValue<double>(&quality, features.stmt, 5);
+
+      feature.setUniqueId(row_keys ? sqlite3_column_int64(features.stmt, n_feature_columns) : f_id);
+      feature.setRT(rt);
+      feature.setMZ(mz);
+      feature.setIntensity(intensity);
+      feature.setCharge(charge);
+      feature.setOverallQuality(quality);
+
+      decodeUserParams_(feature, features.stmt, feature_plan);
+      for (; sparse_meta.seek(f_id); sparse_meta.next())
+      {
+        auto it = sparse_decoders.find(sqlite3_column_int64(sparse_meta.stmt, 1));
+        if (it != sparse_decoders.end())
+        {
+          decodeUserParam_(feature, sparse_meta.stmt, it->second);
+        }
+      }
+
+      // boundingboxes of the feature, ordered by BB_IDX
+      for (; feature_bboxes.seek(f_id); feature_bboxes.next())
+      {
+        feature.getConvexHulls().push_back(readBBox_(feature_bboxes.stmt, 0, feature_points));
+      }
+
+      // subordinates of the feature, ordered by SUB_IDX
+      vector<Feature>& feature_subordinates = feature.getSubordinates();
+      map_sid_to_index.clear();
+      for (; subordinates.seek(f_id); subordinates.next())
+      {
+        map_sid_to_index[sqlite3_column_int64(subordinates.stmt, 1)] = feature_subordinates.size();
+        feature_subordinates.push_back(readSubordinate_(subordinates.stmt, subordinate_plan));
+      }
+
+      // boundingboxes of the subordinates, ordered by SUB_IDX (subordinate ID) and BB_IDX
+      for (; subordinate_bboxes.seek(f_id); subordinate_bboxes.next())
+      {
+        Size sub_idx = feature_subordinates.size();
+        if (sqlite3_column_type(subordinate_bboxes.stmt, 2) != SQLITE_NULL)
+        {
+          sub_idx = static_cast<Size>(sqlite3_column_int64(subordinate_bboxes.stmt, 2));
+        }
+        else
+        {
+          auto it = map_sid_to_index.find(sqlite3_column_int64(subordinate_bboxes.stmt, 1));
+          if (it != map_sid_to_index.end())
+          {
+            sub_idx = it->second;
+          }
+        }
+        if (sub_idx < feature_subordinates.size())
+        {
+          feature_subordinates[sub_idx].getConvexHulls().push_back(readBBox_(subordinate_bboxes.stmt, 2, subordinate_points));
+        }
+      }
+
+      consumer(feature);
+    }
+  }
+
+  // number of features from the summary if present, counted otherwise
+  Size storedFeatureCount_(sqlite3* db)
+  {
+    Size n_features = 0;
+    if (SqliteConnector::tableExists(db, "FEATURES_SUMMARY"))
+    {
+      sqlite3_stmt* stmt = nullptr;
+      SqliteConnector::prepareStatement(db, &stmt, "SELECT FEATURES FROM FEATURES_SUMMARY;");
+      if (sqlite3_step(stmt) == SQLITE_ROW)
+      {
+        n_features = static_cast<Size>(sqlite3_column_int64(stmt, 0));
+      }
+      sqlite3_finalize(stmt);
+    }
+    else
+    {
+      n_features = countRows_(db, "FEATURES_TABLE");
+    }
+    return n_features;
+  }
+
+  // split FEATURES_TABLE into ID ranges for concurrent reading
+  // returns lower ID bounds of all ranges followed by the largest ID, i.e. less than three entries
+  // if the database should be read by a single thread
+  vector<int64_t> shardBoundaries_(sqlite3* db)
+  {
+    vector<int64_t> boundaries;
+    Size n_threads = 1;
+#ifdef _OPENMP
+    n_threads = omp_get_max_threads();
+#endif
+    if (n_threads < 2 || !SqliteConnector::tableExists(db, "FEATURES_TABLE"))
+    {
+      return boundaries;
+    }
+
+    // shards of less than min_shard_size features are not worth an own connection
+    const Size min_shard_size = 1000;
+    const Size n_features = storedFeatureCount_(db);
+
+    // MIN/MAX are single lookups in the rowid B-tree
+    sqlite3_stmt* stmt = nullptr;
+    SqliteConnector::prepareStatement(db, &stmt, "SELECT MIN(ID), MAX(ID) FROM FEATURES_TABLE;");
+    sqlite3_step(stmt);
+    const int64_t min_id = sqlite3_column_int64(stmt, 0);
+    const int64_t max_id = sqlite3_column_int64(stmt, 1);
+    sqlite3_finalize(stmt);
+
+    // the ID range is split evenly, which balances unique IDs (random) as well as consecutive ones;
+    // more shards than threads (scheduled dynamically) even out denser ID ranges
+    const uint64_t span = static_cast<uint64_t>(max_id) - static_cast<uint64_t>(min_id);
+    const Size n_shards = std::min<uint64_t>(std::min(4 * n_threads, n_features / min_shard_size), span);
+    if (n_shards < 2)
+    {
+      return boundaries;
+    }
+    for (Size k = 0; k < n_shards; ++k)
+    {
+      boundaries.push_back(static_cast<int64_t>(static_cast<uint64_t>(min_id) + span / n_shards * k));
+    }
+    boundaries.push_back(max_id);
+    return boundaries;
+  }
+
+  // reading helper function
+  // dataprocessing entry (without userparams) from the SOFTWARE, SOFTWARE_VERSION, DATA, TIME and ACTIONS columns starting at first_column
+  DataProcessing readDataProcessingEntry_(sqlite3_stmt* stmt, int first_column)
+  {
+    String software;
+    Sql::extractValue<String>(&software, stmt, first_column);
+    String software_name;
+    Sql::extractValue<String>(&software_name, stmt, first_column + 1);
+    String data;
+    Sql::extractValue<String>(&data, stmt, first_column + 2);
+    String time;
+    Sql::extractValue<String>(&time, stmt, first_column + 3);
+    String actions;
+    Sql::extractValue<String>(&actions, stmt, first_column + 4);
+
+    DataProcessing dp;
+
+    //software
+    dp.getSoftware().setName(software);
+    dp.getSoftware().setVersion(software_name);
+
+    //time
+    DateTime date_time;
+    date_time.set(data + " " + time);
+    dp.setCompletionTime(date_time);
+
+    // actions are stored as comma separated enum values
+    StringList proc_acts;
+    actions.split(",", proc_acts);
+
+    set<DataProcessing::ProcessingAction> proc_actions;
+    for (auto action : proc_acts)
+    {
+      proc_actions.insert((DataProcessing::ProcessingAction)action.toInt());
+    }
+    dp.setProcessingActions(proc_actions);
+    return dp;
+  }
+
+  // read dataprocessing entries and ID of feature map
+  void readDataProcessing_(sqlite3* db, FeatureMap& feature_map)
+  {
+    sqlite3_stmt * stmt = NULL;
+
+    if (SqliteConnector::tableExists(db, "FEATURES_DATAPROCESSING"))
     {
       /// 1. get feature data from database
-      SqliteConnector::prepareStatement(db, &stmt, features_sql);
+      String sql = "SELECT * FROM  FEATURES_DATAPROCESSING ORDER BY rowid;";
+      SqliteConnector::prepareStatement(db, &stmt, sql);
+      // userparams follow ID, SOFTWARE, SOFTWARE_VERSION, DATA, TIME and ACTIONS
+      const DecoderPlan_ plan = compileDecoders_(stmt, 6, sqlite3_column_count(stmt));
       sqlite3_step(stmt);
-      
-      Feature* feature = nullptr;
-      bool has_bbox = false;
-
-      // set f_id_prev to 0 to ensure that if an id is read 
-      // a new entry in the feature_map can be generated
-      int64_t f_id_prev = 0;            
-      //int counter = 0;
 
       while (sqlite3_column_type( stmt, 0 ) != SQLITE_NULL)
       {
-        int64_t f_id = 0;
-        String id_str;
-        // return value of feature ID in column #0
-        Sql::extractValue<String>(&id_str, stmt, 0);    
-        istringstream iss(id_str);
-        iss >> f_id;
-
-        int64_t ref_id = 0;
-        String ref_id_str;
-        // return position of REF_ID to check for bbox entries
-        Sql::extractValue<String>(&ref_id_str, stmt, cols_features);
-        istringstream issref(ref_id_str);
-        issref >> ref_id;
-
-        int bbox_idx = 0;
-        if (ref_id == 0)
-        {
-          has_bbox = false; // no bbox, ref_id is 0
-        } 
-        else if (ref_id != 0)
-        {
-          has_bbox = true;
-          // return position of last entry in query
-          Sql::extractValue<int>(&bbox_idx, stmt, (cols_features + cols_features_bbox - 1));          
-        }
+        // set dataprocessing parameters
+        size_t id = sqlite3_column_int64(stmt, 0);
 
-        if (f_id != f_id_prev)
-        {
-          feature_map.push_back(Feature());
-          f_id_prev = f_id; // set previous feature id 
-        }
+        // save SQL column elements as dataprocessing
+        feature_map.setUniqueId(id);
+        DataProcessing dp = readDataProcessingEntry_(stmt, 1);
+        decodeUserParams_(dp, stmt, plan);
 
-        // push back if f_id != f_id_prev
+        feature_map.getDataProcessing().push_back(dp);
+        sqlite3_step(stmt);
+      }
 
-        feature = &feature_map[feature_map.size() - 1];
+      sqlite3_finalize(stmt);
+    }
+  }
 
-        // get values id, RT, MZ, Intensity, Charge, Quality
+  // reading helper function
+  // runs catalog of a multi-run file in order of the run IDs
+  vector<FeatureSQLFile::RunInfo> readRunCatalog_(sqlite3* db)
+  {
+    vector<FeatureSQLFile::RunInfo> runs;
+    sqlite3_stmt* stmt = nullptr;
+    SqliteConnector::prepareStatement(db, &stmt, "SELECT RUN_ID, MAP_ID, IDENTIFIER, MS_RUN_PATH, FEATURES FROM FEATURES_RUNS ORDER BY RUN_ID;");
+    while (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+      FeatureSQLFile::RunInfo run;
+      run.run_id = static_cast<Size>(sqlite3_column_int64(stmt, 0));
+      run.map_id = static_cast<UInt64>(sqlite3_column_int64(stmt, 1));
+      Sql::extractValue<String>(&run.identifier, stmt, 2);
+      if (sqlite3_column_type(stmt, 3) != SQLITE_NULL)
+      {
+        const unsigned char* data = static_cast<const unsigned char*>(sqlite3_column_blob(stmt, 3));
+        run.primary_ms_run_path = fromSQLStringBlob_(data, sqlite3_column_bytes(stmt, 3));
+      }
+      run.features = static_cast<Size>(sqlite3_column_int64(stmt, 4));
+      runs.push_back(run);
+    }
+    sqlite3_finalize(stmt);
+    return runs;
+  }
 
+  // reading helper function
+  // dataprocessing entries of a run of a multi-run file
+  void readRunDataProcessing_(sqlite3* db, Size run_id, FeatureMap& feature_map)
+  {
+    sqlite3_stmt* stmt = nullptr;
+    SqliteConnector::prepareStatement(db, &stmt, "SELECT * FROM FEATURES_RUN_DATAPROCESSING WHERE RUN_ID = " + String(run_id) + " ORDER BY DP_IDX;");
+    // userparams follow RUN_ID, DP_IDX, SOFTWARE, SOFTWARE_VERSION, DATA, TIME and ACTIONS
+    const DecoderPlan_ plan = compileDecoders_(stmt, 7, sqlite3_column_count(stmt));
+    while (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+      DataProcessing dp = readDataProcessingEntry_(stmt, 2);
+      decodeUserParams_(dp, stmt, plan);
+      feature_map.getDataProcessing().push_back(dp);
+    }
+    sqlite3_finalize(stmt);
+  }
 
-        //DEBUG
-        //cout << counter << "nth feature with id: " << f_id << endl;
-        //int ref_id = 0;
-        //Sql::extractValue<int>(&ref_id, stmt, 56);
-        //++counter;
+  //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+  //                                                   read FeatureMap as SQL database                                                    //
+  //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+  // read SQL database and store as FeatureMap
+  // fitted snippet of FeatureXMLFile::load
+  // based on TransitionPQPFile::readPQPInput
 
-        double rt = 0.0;
-        Sql::extractValue<double>(&rt, stmt, 1);
-        double mz = 0.0;
-        Sql::extractValue<double>(&mz, stmt, 2);
-        double intensity = 0.0;
-        Sql::extractValue<double>(&intensity, stmt, 3);
-        int charge = 0;
-        Sql::extractValue<int>(&charge, stmt, 4);
-        double quality = 0.0;
-        Sql::extractValue<double>(&quality, stmt, 5);
+  FeatureMap FeatureSQLFile::read(const string& filename_, const ReadOptions& options) const
+  {
+    FeatureMap feature_map; // FeatureMap object as feature container
 
-        feature->setUniqueId(f_id);
-        feature->setRT(rt);
-        feature->setMZ(mz);
-        feature->setIntensity(intensity);
-        feature->setCharge(charge);
-        feature->setOverallQuality(quality);
+    ReadConnection_ conn(filename_, options.immutable); // Open database
+    sqlite3* db = conn.getDB();
 
-        int col_nr = 6; // index to account for offsets in joined tables
+    //////////////////////////////////////////////////////////////////////////////////////////
+    // store sqlite3 database as FeatureMap                                                 //
+    // 1. dataprocessing                                                                    //
+    // 2. features with subordinates and boundingboxes                                      //
+    //////////////////////////////////////////////////////////////////////////////////////////
+    if (options.dataprocessing)
+    {
+      readDataProcessing_(db, feature_map);
+    }
 
-        if (cols_features != col_nr)
-        {
-          for (int i = col_nr; i < cols_features ; ++i)  // save userparam columns
-          {
-            String column_name = sqlite3_column_name(stmt, i);
-            int column_type = getColumnDatatype_(column_name);
-            
-            // test if database column value is NULL
-            if (sqlite3_column_type(stmt,i) == SQLITE_NULL)
-            {
-              break;
-            }
-            else if (column_type == DataValue::STRING_VALUE)
-            {
-              column_name = column_name.substr(3);
-              String value;
-              Sql::extractValue<String>(&value, stmt, i);
-              feature->setMetaValue(column_name, value); 
-              continue;
-            } 
-            else if (column_type == DataValue::INT_VALUE)
-            {
-              column_name = column_name.substr(3);
-              int value = 0;
-              Sql::extractValue<int>(&value, stmt, i);
-              feature->setMetaValue(column_name, value); 
-              continue;
-            } 
-            else if (column_type == DataValue::DOUBLE_VALUE)
-            {
-              column_name = column_name.substr(3);
-              double value = 0.0;
-              Sql::extractValue<double>(&value, stmt, i);          
-              feature->setMetaValue(column_name, value); 
-              continue;
-            } 
-            else if (column_type == DataValue::STRING_LIST)
-            {
-              column_name = column_name.substr(4);
-              String value; 
-              Sql::extractValue<String>(&value, stmt, i);
-
-              StringList sl;
-              // cut off "[" and "]""
-              value = value.chop(1);
-              value = value.substr(1);
-              value.split(", ", sl);
-              feature->setMetaValue(column_name, sl);
-              continue;
-            } 
-            else if (column_type == DataValue::INT_LIST)
-            {
-              column_name = column_name.substr(4);
-              String value; //IntList value;
-              Sql::extractValue<String>(&value, stmt, i); //IntList
-              value = value.chop(1);
-              value = value.substr(1);
-              vector<String> value_list;
-              IntList il = ListUtils::create<int>(value, ',');
-              feature->setMetaValue(column_name, il);
-              continue;
-            } 
-            else if (column_type == DataValue::DOUBLE_LIST)
-            {
-              column_name = column_name.substr(4);
-              String value; //DoubleList value;
-              Sql::extractValue<String>(&value, stmt, i); //DoubleList
-              value = value.chop(1);
-              value = value.substr(1);          
-              DoubleList dl = ListUtils::create<double>(value, ',');
-              feature->setMetaValue(column_name, dl);
-              continue;
-            } 
-            else if (column_type == DataValue::EMPTY_VALUE)
-            {
-              //cout << " else if (column_type == DataValue::EMPTY_VALUE " << column_type << endl;
-              break;
-              //String value;
-              //Sql::extractValue<String>(&value, stmt, i);
-              //continue;
-            }
-          }
-        }
-        
-        if (has_bbox == false) // add  bbox to feature if present
+    // features are collected in order of their IDs
+    // large databases are split into ID ranges which are decoded concurrently
+    const vector<int64_t> boundaries = shardBoundaries_(db);
+    if (boundaries.size() <= 2)
+    {
+      streamFeatures_(db, [&feature_map](Feature& feature) { feature_map.push_back(std::move(feature)); }, options);
+      return feature_map;
+    }
+
+    const SignedSize n_shards = static_cast<SignedSize>(boundaries.size()) - 1;
+    vector<vector<Feature> > shards(n_shards);
+    String read_error;
+#pragma omp parallel for schedule(dynamic)
+    for (SignedSize k = 0; k < n_shards; ++k)
+    {
+      try
+      {
+        // every thread reads through its own connection
+        ReadConnection_ shard_conn(filename_, options.immutable);
+        shard_conn.executeStatement("PRAGMA query_only = ON;");
+        const String lower = String(boundaries[k]);
+        const String upper = k != n_shards - 1 ? String(boundaries[k + 1]) : String();
+        IDFilter_ id_filter = [&lower, &upper](const String& id_column)
         {
-          map_fid_to_index[feature->getUniqueId()] = feature_map.size() - 1; 
-        }
-        else if (has_bbox == true)
+          return upper.empty() ? id_column + " >= " + lower : id_column + " >= " + lower + " AND " + id_column + " < " + upper;
+        };
+        vector<Feature>& shard = shards[k];
+        streamFeatures_(shard_conn.getDB(), [&shard](Feature& feature) { shard.push_back(std::move(feature)); }, options, id_filter);
+      }
+      catch (Exception::BaseException& e)
+      {
+#pragma omp critical (FeatureSQLFile_read)
+        read_error = e.what();
+      }
+    }
+    if (!read_error.empty())
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, read_error);
+    }
+
+    // stitch shards in ID order
+    feature_map.reserve(feature_map.size() + accumulate(shards.begin(), shards.end(), Size(0), [](Size n, const vector<Feature>& shard) { return n + shard.size(); }));
+    for (vector<Feature>& shard : shards)
+    {
+      for (Feature& feature : shard)
+      {
+        feature_map.push_back(std::move(feature));
+      }
+      vector<Feature>().swap(shard);
+    }
+
+    return feature_map;
+  }  // end of FeatureSQLFile::read
+
+  void FeatureSQLFile::readStreaming(const string& in_featureSQL, const FeatureConsumer& consumer, const ReadOptions& options) const
+  {
+    ReadConnection_ conn(in_featureSQL, options.immutable);
+    streamFeatures_(conn.getDB(), consumer, options);
+  }
+
+  FeatureSQLFile::FeatureColumns FeatureSQLFile::readColumns(const string& in_featureSQL) const
+  {
+    FeatureColumns columns;
+
+    SqliteConnector conn(in_featureSQL);
+    sqlite3* db = conn.getDB();
+    if (!SqliteConnector::tableExists(db, "FEATURES_TABLE"))
+    {
+      return columns;
+    }
+
+    const Size n_features = storedFeatureCount_(db);
+    sqlite3_stmt* stmt = nullptr;
+    columns.id.reserve(n_features);
+    columns.rt.reserve(n_features);
+    columns.mz.reserve(n_features);
+    columns.intensity.reserve(n_features);
+    columns.charge.reserve(n_features);
+    columns.quality.reserve(n_features);
+
+    // ID is the rowid, so ordering costs nothing; NULL values are read as 0
+    SqliteConnector::prepareStatement(db, &stmt, "SELECT " + featureIdColumn_(db) + ", RT, MZ, Intensity, Charge, Quality FROM FEATURES_TABLE ORDER BY ID;");
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW)
+    {
+      columns.id.push_back(static_cast<UInt64>(sqlite3_column_int64(stmt, 0)));
+      columns.rt.push_back(sqlite3_column_double(stmt, 1));
+      columns.mz.push_back(sqlite3_column_double(stmt, 2));
+      columns.intensity.push_back(sqlite3_column_double(stmt, 3));
+      columns.charge.push_back(sqlite3_column_int(stmt, 4));
+      columns.quality.push_back(sqlite3_column_double(stmt, 5));
+    }
+    sqlite3_finalize(stmt);
+    if (rc != SQLITE_DONE)
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Error reading FEATURES_TABLE: " + String(sqlite3_errmsg(db)));
+    }
+    return columns;
+  }
+
+  FeatureMap FeatureSQLFile::readRegion(const string& in_featureSQL, double rt_min, double rt_max, double mz_min, double mz_max, const ReadOptions& options) const
+  {
+    FeatureMap feature_map;
+
+    ReadConnection_ conn(in_featureSQL, options.immutable);
+    sqlite3* db = conn.getDB();
+
+    if (options.dataprocessing)
+    {
+      readDataProcessing_(db, feature_map);
+    }
+
+    // preselect candidate IDs from the region index (conservative for R*Tree's 32 bit coordinates),
+    // databases written without index are scanned completely
+    IDFilter_ id_filter;
+    if (SqliteConnector::tableExists(db, "FEATURES_REGION_INDEX"))
+    {
+      conn.executeStatement("DROP TABLE IF EXISTS temp.REGION_IDS;");
+      sqlite3_stmt* stmt = nullptr;
+      SqliteConnector::prepareStatement(db, &stmt, "CREATE TEMP TABLE REGION_IDS AS SELECT ID FROM FEATURES_REGION_INDEX \
+                                                    WHERE max_RT >= ? AND min_RT <= ? AND max_MZ >= ? AND min_MZ <= ?;");
+      checkBind_(db, sqlite3_bind_double(stmt, 1, rt_min));
+      checkBind_(db, sqlite3_bind_double(stmt, 2, rt_max));
+      checkBind_(db, sqlite3_bind_double(stmt, 3, mz_min));
+      checkBind_(db, sqlite3_bind_double(stmt, 4, mz_max));
+      stepStatement_(db, stmt);
+      sqlite3_finalize(stmt);
+      id_filter = [](const String& id_column) { return id_column + " IN (SELECT ID FROM temp.REGION_IDS)"; };
+    }
+
+    // exact test of the extent of reconstructed features, which needs their convex hulls
+    ReadOptions region_options = options;
+    region_options.convex_hulls = true;
+    streamFeatures_(db, [&](Feature& feature)
+    {
+      const DBoundingBox<2> extent = featureExtent_(feature);
+      if (extent.maxX() >= rt_min && extent.minX() <= rt_max && extent.maxY() >= mz_min && extent.minY() <= mz_max)
+      {
+        if (!options.convex_hulls)
         {
-          if (bbox_idx == 0)
-          {
-            ConvexHull2D hull = readBBox_(stmt, cols_features);
-            feature->getConvexHulls().push_back(hull);
-            map_fid_to_index[feature->getUniqueId()] = feature_map.size() - 1; 
-          }
-          else if (bbox_idx > 0) // add new bb to existing feature
+          feature.getConvexHulls().clear();
+          for (Feature& subordinate : feature.getSubordinates())
           {
-            ConvexHull2D hull = readBBox_(stmt, cols_features);
-            feature->getConvexHulls().push_back(hull);
+            subordinate.getConvexHulls().clear();
           }
         }
-      
-        sqlite3_step(stmt);  
+        feature_map.push_back(std::move(feature));
       }
-      sqlite3_finalize(stmt);
-    } 
-    // end of features ##########################################
+    }, region_options, id_filter);
+
+    return feature_map;
+  }
 
+  FeatureMap FeatureSQLFile::readByIds(const string& in_featureSQL, const vector<UInt64>& ids, const ReadOptions& options) const
+  {
+    FeatureMap feature_map;
 
-  //*/
+    ReadConnection_ conn(in_featureSQL, options.immutable);
+    sqlite3* db = conn.getDB();
 
-  /*
-    for (map<int64_t, size_t>::iterator it = map_fid_to_index.begin(); it != map_fid_to_index.end(); ++it)
+    if (options.dataprocessing)
     {
-      cout << "Value at " <<  it->first << " is " << it->second << endl;
+      readDataProcessing_(db, feature_map);
     }
-  */
 
-    // get subordinate entries #########################################
-    if (subordinates_switch_)
+    // positions in ids by stored (masked) ID
+    unordered_map<int64_t, vector<Size> > id2positions;
+    for (Size pos = 0; pos != ids.size(); ++pos)
     {
-      SqliteConnector::prepareStatement(db, &stmt, subordinates_sql);
-      sqlite3_step(stmt);
-      int column_nr = 0;
-      int64_t f_id_prev = 0;
-      int64_t sub_id_prev = 0;
-      bool has_bbox = false;
-      int bbox_idx = 0;
+      id2positions[static_cast<int64_t>(ids[pos] & ~(1ULL << 63))].push_back(pos);
+    }
+    if (id2positions.empty())
+    {
+      return feature_map;
+    }
 
-      int64_t f_id = 0; // get feature id entries for feature- and userparameters
-      String f_id_string;
+    // requested IDs in ascending order as primary key of a temporary table,
+    // so every cursor looks up its rows by index in the order the features are merged
+    vector<int64_t> requested;
+    requested.reserve(id2positions.size());
+    for (const auto& id2pos : id2positions)
+    {
+      requested.push_back(id2pos.first);
+    }
+    sort(requested.begin(), requested.end());
+    conn.executeStatement("DROP TABLE IF EXISTS temp.REQUESTED_IDS;");
+    conn.executeStatement("CREATE TEMP TABLE REQUESTED_IDS (ID INTEGER PRIMARY KEY);");
+    sqlite3_stmt* stmt = nullptr;
+    SqliteConnector::prepareStatement(db, &stmt, "INSERT INTO temp.REQUESTED_IDS (ID) VALUES (?);");
+    for (int64_t id : requested)
+    {
+      checkBind_(db, sqlite3_bind_int64(stmt, 1, id));
+      stepStatement_(db, stmt);
+    }
+    sqlite3_finalize(stmt);
 
-      int64_t sub_id = 0; // get subordinate id entries for feature- and userparameters
-      String sub_id_string;
+    // in multi-run files the requested IDs are looked up by the FEATURE_ID index and may belong to several runs
+    IDFilter_ id_filter = [](const String& id_column) { return id_column + " IN (SELECT ID FROM temp.REQUESTED_IDS)"; };
+    if (SqliteConnector::columnExists(db, "FEATURES_TABLE", "FEATURE_ID"))
+    {
+      id_filter = [](const String& id_column)
+      {
+        return id_column + " IN (SELECT FEATURES_TABLE.ID FROM temp.REQUESTED_IDS CROSS JOIN FEATURES_TABLE ON FEATURES_TABLE.FEATURE_ID = REQUESTED_IDS.ID)";
+      };
+    }
 
-      int64_t cvhull_id = 0; // get bbox id entries of convex hulls by subordinate-> boundingboxes
-      String cvhull_id_string;
+    // features arrive by ascending row key (runs in the order they were written) and are put in place of their request
+    vector<vector<Feature> > features(ids.size());
+    streamFeatures_(db, [&](Feature& feature)
+    {
+      const vector<Size>& positions = id2positions.at(static_cast<int64_t>(feature.getUniqueId()));
+      for (Size k = 0; k + 1 < positions.size(); ++k)
+      {
+        features[positions[k]].push_back(feature);
+      }
+      features[positions.back()].push_back(std::move(feature));
+    }, options, id_filter);
 
-      while (sqlite3_column_type( stmt, 0 ) != SQLITE_NULL)       // while joined table still has entries continue 
+    for (vector<Feature>& requested_features : features)
+    {
+      for (Feature& feature : requested_features)
       {
-        Sql::extractValue<String>(&f_id_string, stmt, 0);
-        istringstream issf(f_id_string);
-        issf >> f_id;
+        feature_map.push_back(std::move(feature));
+      }
+    }
+    return feature_map;
+  }
 
-        // case of features with subordinates with and without boundingboxes (due to changes in column number)
-        if (subordinates_switch_)  // features with subordinates but no boundingbox
-        {
-          // extract sub_id
-          Sql::extractValue<String>(&sub_id_string, stmt, (cols_features));
-          istringstream issub(sub_id_string);
-          issub >> sub_id;
-          //cout << "sub_id " << sub_id << endl;
-
-        } 
-        else if (subordinates_bbox_switch_)
-        {
-          // extract sub_id
-          Sql::extractValue<String>(&sub_id_string, stmt, (cols_features + cols_subordinates));
-          istringstream issub(sub_id_string);
-          issub >> sub_id;
-          //cout << "sub_id " << sub_id << endl;
-
-          // extract REF_ID
-          Sql::extractValue<String>(&cvhull_id_string, stmt, (cols_features + cols_subordinates));
-          istringstream issref(cvhull_id_string);
-          issref >> cvhull_id;
-          //cout << "cvhull_id " << cvhull_id << endl;
-        }
+  FeatureSQLFile::RunInfo::RunInfo() :
+    run_id(0),
+    map_id(0),
+    features(0)
+  {
+  }
 
-        // test presence of convex hulls 
-        if (cvhull_id == 0)  // 0 as impossible value for UniqueIdinterface, cast NULL to 0 via extractValue()
-        {
-          has_bbox = false; // no bbox, cvhull_id is 0
-          //cout << "\ncvhull_id is " << cvhull_id << endl;
-        } 
-        else if (cvhull_id != 0) // value of cvhull_id is not NULL and fits the UniqueIdInterface
-        {
-          has_bbox = true;  // bbox is present
-          Sql::extractValue<int>(&bbox_idx, stmt, (cols_features + cols_subordinates + cols_subordinates_bbox - 1)); // last column with subordinate bbox_idx of joined table          
-          //cout << "\ncvhull_id " << cvhull_id << " has bbox_idx with " << bbox_idx << " as value." << endl;
-        }
+  vector<FeatureSQLFile::RunInfo> FeatureSQLFile::readRunCatalog(const string& in_featureSQL) const
+  {
+    if (!File::exists(in_featureSQL))
+    {
+      throw Exception::FileNotFound(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, in_featureSQL);
+    }
+    SqliteConnector conn(in_featureSQL);
+    if (!SqliteConnector::tableExists(conn.getDB(), "FEATURES_RUNS"))
+    {
+      return vector<RunInfo>();
+    }
+    return readRunCatalog_(conn.getDB());
+  }
 
+  vector<FeatureMap> FeatureSQLFile::readRuns(const string& in_featureSQL, const vector<Size>& run_ids, const ReadOptions& options) const
+  {
+    ReadConnection_ conn(in_featureSQL, options.immutable);
+    sqlite3* db = conn.getDB();
+    if (!SqliteConnector::tableExists(db, "FEATURES_RUNS"))
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, in_featureSQL + " is not a multi-run featureSQL file.");
+    }
 
-        Feature* feature = &feature_map[map_fid_to_index[f_id]];  // get index of feature vector subordinates at index of id
-        vector<Feature>* subordinates = &feature->getSubordinates(); 
+    map<Size, RunInfo> catalog;
+    for (const RunInfo& run : readRunCatalog_(db))
+    {
+      catalog[run.run_id] = run;
+    }
 
-        // break current query if subordinate entry is 0, case is possible        
-        if (sub_id == 0)
-        {
-          //cout << "no subordinate" << endl;
-          sqlite3_step(stmt);
-          continue;
-        } 
+    vector<FeatureMap> feature_maps(run_ids.size());
+    for (Size idx = 0; idx != run_ids.size(); ++idx)
+    {
+      auto run = catalog.find(run_ids[idx]);
+      if (run == catalog.end())
+      {
+        throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Run " + String(run_ids[idx]) + " is not stored in " + in_featureSQL + ".");
+      }
+      FeatureMap& feature_map = feature_maps[idx];
+      feature_map.setUniqueId(run->second.map_id);
+      feature_map.setIdentifier(run->second.identifier);
+      feature_map.setPrimaryMSRunPath(run->second.primary_ms_run_path);
+      if (options.dataprocessing)
+      {
+        readRunDataProcessing_(db, run->first, feature_map);
+      }
+      feature_map.reserve(run->second.features);
 
-        if (f_id != f_id_prev) // new feature -> presumes new cvhull_id has bbox with bbox_idx being 0
-        {
-          //cout << "f_id != f_id_prev; f_id: " << f_id << " f_id_prev: " << f_id_prev << endl;
-          //cout << "new feature and new subordinate id " << sub_id << endl;
-          f_id_prev = f_id; // set previous to current feature for subordinate storage
-          sub_id_prev = sub_id;
-      
-          column_nr = cols_features + 1 + 1;  // size of features column + column SUB_IDX + column REF_ID
-          if (cvhull_id == 0)
-          {
-            //cout << "... but no convexhull" << endl;
-            subordinates->push_back(readSubordinate_(stmt, column_nr, cols_features, cols_subordinates, has_bbox)); // read subordinate w/o bbox
-          }
-          else if (cvhull_id != 0)
-          {
-            //cout << "...  and convexhull" << endl;
-            subordinates->push_back(readSubordinate_(stmt, column_nr, cols_features, cols_subordinates, has_bbox)); // read subordinate with first bounding box
-          }
+      // features of the run are looked up in row key order by the (RUN_ID, ID) index, their dependent rows by REF_ID
+      const String run_literal = String(run->first);
+      streamFeatures_(db, [&feature_map](Feature& feature) { feature_map.push_back(std::move(feature)); }, options, [&run_literal](const String& id_column)
+      {
+        return id_column == "FEATURES_TABLE.ID" ? "FEATURES_TABLE.RUN_ID = " + run_literal
+                                                : id_column + " IN (SELECT ID FROM FEATURES_TABLE WHERE RUN_ID = " + run_literal + ")";
+      });
+    }
+    return feature_maps;
+  }
 
-        }
-        else // same feature
-        {   
-          //cout << "f_id == f_id_prev; f_id: " << f_id << " f_id_prev: " << f_id_prev << endl;
-          //cout << "same feature with f_id  " << f_id << ", sub_id " << sub_id << " and sub_id_prev " << sub_id_prev  << endl;
-          
-          //  test if subordinate is equal to previous subordinate
-            
-          
-          if (sub_id_prev == sub_id)
-          {
-            //cout << " same subordinate, add bbox to its convexhull " << sub_id << endl;
-            (*subordinates)[subordinates->size()-1].getConvexHulls().push_back(readBBox_(stmt, column_nr));
-          }
-          else if (sub_id_prev != sub_id)
-          {
-            //cout << " different subordinate, push back to subordinates " << sub_id << endl;
-            subordinates->push_back(readSubordinate_(stmt, column_nr, cols_features, cols_subordinates, has_bbox)); // read subordinate with first bounding box
+  // reading helper function
+  // hits of the queries (sorted by m/z, with their tolerance windows [lower, upper]) in FEATURES_TABLE of db, ascending by m/z
+  // features are scanned once in m/z order, through the m/z index only within the (merged) windows
+  void searchMZ_(sqlite3* db, const String& filename, const vector<pair<double, Size> >& queries, const vector<pair<double, double> >& windows,
+                 double rt_min, double rt_max, vector<FeatureSQLFile::MZHit>& hits)
+  {
+    if (!SqliteConnector::tableExists(db, "FEATURES_TABLE"))
+    {
+      return;
+    }
 
-          }
+    // overlapping windows are merged, so every feature is read at most once
+    vector<pair<double, double> > ranges;
+    for (const auto& window : windows)
+    {
+      if (!ranges.empty() && window.first <= ranges.back().second)
+      {
+        ranges.back().second = max(ranges.back().second, window.second);
+      }
+      else
+      {
+        ranges.push_back(window);
+      }
+    }
 
-        }
+    String rt_condition;
+    if (rt_min > -numeric_limits<double>::max())
+    {
+      rt_condition += " AND FEATURES_TABLE.RT >= " + sqlLiteral_(SQLValue_(rt_min));
+    }
+    if (rt_max < numeric_limits<double>::max())
+    {
+      rt_condition += " AND FEATURES_TABLE.RT <= " + sqlLiteral_(SQLValue_(rt_max));
+    }
 
-        sqlite3_step(stmt);
-      } // end of while of subordinate entries
+    String sql;
+    sqlite3_stmt* stmt = nullptr;
+    SqliteConnector::prepareStatement(db, &stmt, "SELECT 1 FROM sqlite_master WHERE type = 'index' AND name = 'FEATURES_TABLE_MZ';");
+    const bool mz_index = sqlite3_step(stmt) == SQLITE_ROW;
+    sqlite3_finalize(stmt);
+    if (mz_index)
+    {
+      // ranges in a temporary table drive range scans of the index, in order of the ranges and m/z
+      SqliteConnector::executeStatement(db, "DROP TABLE IF EXISTS temp.MZ_RANGES;");
+      SqliteConnector::executeStatement(db, "CREATE TEMP TABLE MZ_RANGES (IDX INTEGER PRIMARY KEY, LOWER REAL NOT NULL, UPPER REAL NOT NULL);");
+      SqliteConnector::prepareStatement(db, &stmt, "INSERT INTO temp.MZ_RANGES (IDX, LOWER, UPPER) VALUES (?,?,?);");
+      for (Size idx = 0; idx != ranges.size(); ++idx)
+      {
+        checkBind_(db, sqlite3_bind_int64(stmt, 1, static_cast<sqlite3_int64>(idx)));
+        checkBind_(db, sqlite3_bind_double(stmt, 2, ranges[idx].first));
+        checkBind_(db, sqlite3_bind_double(stmt, 3, ranges[idx].second));
+        stepStatement_(db, stmt);
+      }
       sqlite3_finalize(stmt);
+      sql = "SELECT FEATURES_TABLE." + featureIdColumn_(db) + ", FEATURES_TABLE.RT, FEATURES_TABLE.MZ, FEATURES_TABLE.Intensity, FEATURES_TABLE.Charge \
+             FROM temp.MZ_RANGES CROSS JOIN FEATURES_TABLE INDEXED BY FEATURES_TABLE_MZ \
+             WHERE FEATURES_TABLE.MZ >= MZ_RANGES.LOWER AND FEATURES_TABLE.MZ <= MZ_RANGES.UPPER" + rt_condition + " ORDER BY MZ_RANGES.IDX, FEATURES_TABLE.MZ;";
+    }
+    else
+    {
+      // files written without m/z index: single scan of the span of all windows
+      sql = "SELECT " + featureIdColumn_(db) + ", RT, MZ, Intensity, Charge FROM FEATURES_TABLE WHERE MZ >= " + sqlLiteral_(SQLValue_(ranges.front().first)) +
+            " AND MZ <= " + sqlLiteral_(SQLValue_(ranges.back().second)) + rt_condition + " ORDER BY MZ;";
     }
-    // end of subordinates ############################################
-  
 
-    return feature_map;
-  }  // end of FeatureSQLFile::read
+    // merge of the features and the queries, both ascending by m/z;
+    // upper ends of the windows ascend with the queries as the tolerance is relative
+    SqliteConnector::prepareStatement(db, &stmt, sql);
+    Size first = 0;
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW)
+    {
+      const double mz = sqlite3_column_double(stmt, 2);
+      while (first != windows.size() && windows[first].second < mz)
+      {
+        ++first;
+      }
+      for (Size k = first; k != windows.size() && windows[k].first <= mz; ++k)
+      {
+        FeatureSQLFile::MZHit hit;
+        hit.file = filename;
+        hit.query = queries[k].second;
+        hit.id = static_cast<UInt64>(sqlite3_column_int64(stmt, 0));
+        hit.rt = sqlite3_column_double(stmt, 1);
+        hit.mz = mz;
+        hit.intensity = sqlite3_column_double(stmt, 3);
+        hit.charge = sqlite3_column_int(stmt, 4);
+        hits.push_back(hit);
+      }
+    }
+    sqlite3_finalize(stmt);
+    if (rc != SQLITE_DONE)
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Error searching " + filename + ": " + String(sqlite3_errmsg(db)));
+    }
+  }
+
+  FeatureSQLFile::MZHit::MZHit() :
+    query(0),
+    id(0),
+    rt(0.0),
+    mz(0.0),
+    intensity(0.0),
+    charge(0)
+  {
+  }
+
+  vector<FeatureSQLFile::MZHit> FeatureSQLFile::searchMZ(const vector<string>& in_featureSQLs, const vector<double>& mzs, double ppm, double rt_min, double rt_max) const
+  {
+    if (ppm < 0.0)
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "m/z tolerance must not be negative, got " + String(ppm) + " ppm.");
+    }
+    for (const string& filename : in_featureSQLs)
+    {
+      if (!File::exists(filename))
+      {
+        throw Exception::FileNotFound(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+      }
+    }
+    vector<MZHit> hits;
+    if (mzs.empty() || in_featureSQLs.empty())
+    {
+      return hits;
+    }
+
+    // queries (m/z, position in mzs) and their tolerance windows, ascending by m/z
+    vector<pair<double, Size> > queries;
+    queries.reserve(mzs.size());
+    for (Size pos = 0; pos != mzs.size(); ++pos)
+    {
+      queries.emplace_back(mzs[pos], pos);
+    }
+    sort(queries.begin(), queries.end());
+    vector<pair<double, double> > windows;
+    windows.reserve(queries.size());
+    for (const auto& query : queries)
+    {
+      const double tolerance = fabs(query.first) * ppm * 1e-6;
+      windows.emplace_back(query.first - tolerance, query.first + tolerance);
+    }
+
+    // files are searched concurrently, each through its own connection
+    const SignedSize n_files = static_cast<SignedSize>(in_featureSQLs.size());
+    vector<vector<MZHit> > file_hits(n_files);
+    String search_error;
+#pragma omp parallel for schedule(dynamic)
+    for (SignedSize k = 0; k < n_files; ++k)
+    {
+      try
+      {
+        ReadConnection_ conn(in_featureSQLs[k], false);
+        searchMZ_(conn.getDB(), in_featureSQLs[k], queries, windows, rt_min, rt_max, file_hits[k]);
+      }
+      catch (Exception::BaseException& e)
+      {
+#pragma omp critical (FeatureSQLFile_searchMZ)
+        search_error = e.what();
+      }
+    }
+    if (!search_error.empty())
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, search_error);
+    }
+
+    hits.reserve(accumulate(file_hits.begin(), file_hits.end(), Size(0), [](Size n, const vector<MZHit>& h) { return n + h.size(); }));
+    for (vector<MZHit>& h : file_hits)
+    {
+      hits.insert(hits.end(), h.begin(), h.end());
+    }
+    return hits;
+  }
 } // namespace OpenMS
 
 
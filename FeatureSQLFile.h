@@ -37,10 +37,15 @@
 #include <OpenMS/KERNEL/FeatureMap.h>
 
 #include <OpenMS/CONCEPT/Exception.h>
+#include <OpenMS/DATASTRUCTURES/DataValue.h>
 #include <OpenMS/DATASTRUCTURES/String.h>
 #include <OpenMS/KERNEL/StandardTypes.h>
 
+#include <functional>
+#include <limits>
 #include <map>
+#include <memory>
+#include <set>
 
 namespace OpenMS
 {
@@ -59,8 +64,363 @@ namespace OpenMS
   class OPENMS_DLLAPI FeatureSQLFile
   {
     public:
-      void write(const std::string& out_fm, const FeatureMap& fm) const;
-      FeatureMap read(const std::string& in_featureSQL) const;
+      /// callback receiving one fully reconstructed feature (including its subordinates and convex hulls) at a time
+      typedef std::function<void(Feature&)> FeatureConsumer;
+
+      /**
+        @brief Selects the parts of a featureSQL file which are loaded by the read functions
+
+        Only the columns and tables needed are queried. RT, m/z, intensity, charge and quality
+        of features (and subordinates) are always read. By default everything is loaded.
+
+        The filters on intensity, quality, charge and meta values of features are evaluated by SQLite,
+        so features not passing them are never decoded. Bounds are inclusive. Indices written with
+        WriteOptions::index_core_columns and WriteOptions::indexed_meta_keys speed up selective filters.
+      */
+      struct OPENMS_DLLAPI ReadOptions
+      {
+        ReadOptions();
+
+        /// load all meta values, otherwise only those listed in @p meta_keys
+        bool all_meta_values;
+        /// meta keys of features and subordinates to load if @p all_meta_values is false
+        std::set<String> meta_keys;
+        /// load subordinates of features
+        bool subordinates;
+        /// load convex hulls of features and subordinates
+        bool convex_hulls;
+        /// load dataprocessing entries of the feature map (not used by readStreaming)
+        bool dataprocessing;
+        /**
+          @brief open the file read-only as immutable with the whole file memory mapped
+
+          Skips locking and change detection and reads pages without copying them. Only for finished files,
+          e.g. on read-only volumes: results are undefined if the file is changed while it is read.
+        */
+        bool immutable;
+        /// load only features with intensity in [@p intensity_min, @p intensity_max]
+        double intensity_min, intensity_max;
+        /// load only features with overall quality in [@p quality_min, @p quality_max]
+        double quality_min, quality_max;
+        /// load only features with charge in [@p charge_min, @p charge_max]
+        Int charge_min, charge_max;
+        /// load only features whose meta value of every key equals the given (non-empty) value of the same type
+        std::map<String, DataValue> meta_values;
+      };
+
+      /// SQLite settings used by write()
+      enum WriteProfile
+      {
+        DEFAULT_PROFILE, ///< SQLite defaults (rollback journal, synchronous=FULL)
+        BULK_LOAD,       ///< in-memory journal, synchronous=OFF, large page cache and exclusive locking for throwaway intermediate files
+        DURABLE,         ///< write-ahead log with synchronous=FULL
+        IN_MEMORY,       ///< build the database in RAM and store it with a single VACUUM INTO (SQLite < 3.27: online backup)
+        SIZE_OF_WRITEPROFILE
+      };
+
+      /// storage of string meta values, see WriteOptions::string_dictionary
+      enum DictionaryEncoding
+      {
+        DICTIONARY_AUTO,   ///< dictionary encode keys with at most half as many distinct values as values (write() only, the Writer stores plain text)
+        DICTIONARY_ALWAYS, ///< dictionary encode all string meta keys
+        DICTIONARY_NEVER,  ///< store strings as text in every row
+        SIZE_OF_DICTIONARYENCODING
+      };
+
+      /// storage of convex hulls, see WriteOptions::hull_points
+      enum HullPoints
+      {
+        HULL_BOUNDINGBOX,    ///< only the boundingbox of each hull, read as a hull of its two corners
+        HULL_POINTS,         ///< all hull points, lossless
+        HULL_POINTS_FLOAT32, ///< all hull points, each as float32 difference to the previous one (errors do not accumulate)
+        SIZE_OF_HULLPOINTS
+      };
+
+      /**
+        @brief Settings of write()
+      */
+      struct OPENMS_DLLAPI WriteOptions
+      {
+        WriteOptions();
+
+        /// SQLite journal, synchronization and caching settings
+        WriteProfile profile;
+        /// index intensity, quality and charge of features for filtered reads
+        bool index_core_columns;
+        /// meta keys of features whose columns are indexed for filtered reads
+        std::set<String> indexed_meta_keys;
+        /**
+          @brief which string meta keys of features and subordinates are stored dictionary encoded
+
+          Each distinct string is stored once in a dictionary table and rows hold its integer code,
+          which shrinks files with repetitive values (labels, adducts, model names) and lets the readers
+          construct every distinct value only once. Encoded columns hold codes instead of text for other SQL
+          consumers of the file, so encoding is opt-in (default DICTIONARY_NEVER). append() and update() keep
+          the encoding of stored columns and add new string columns as plain text.
+        */
+        DictionaryEncoding string_dictionary;
+        /**
+          @brief minimal fraction of features with a meta key for it to get a column of FEATURES_TABLE
+
+          Rarer keys are stored as (feature ID, key, value) rows of a narrow side table merged in by the readers,
+          so they do not widen every row. 0 (default) stores all keys as columns. The Writer decides on the
+          features of its schema, keys only seen while streaming are stored in the side table if this is positive.
+          append() and update() keep the layout of stored keys and add new keys as columns.
+        */
+        double dense_meta_frequency;
+        /**
+          @brief storage of the convex hulls of features and subordinates
+
+          The boundingbox of every hull is always stored. Hull points are stored as one delta-encoded BLOB per hull
+          next to it and restored by the readers. append() keeps the hull storage of the file.
+        */
+        HullPoints hull_points;
+      };
+
+      /**
+        @brief Summary of a featureSQL file returned by stat()
+
+        Ranges are those of FeatureMap::updateRanges() (feature positions and convex hulls)
+        and are only meaningful if @p features is not 0.
+      */
+      struct OPENMS_DLLAPI Summary
+      {
+        Summary();
+
+        /// version of the featureSQL schema, 0 for files written without summary table
+        Int schema_version;
+        /// number of features
+        Size features;
+        /// number of subordinates (of all features)
+        Size subordinates;
+        /// number of convex hulls of features
+        Size feature_hulls;
+        /// number of convex hulls of subordinates
+        Size subordinate_hulls;
+        /// number of dataprocessing entries (of all runs in multi-run files)
+        Size dataprocessing;
+        /// file has a region index for readRegion()
+        bool region_index;
+        /// RT, m/z and intensity ranges
+        double rt_min, rt_max, mz_min, mz_max, intensity_min, intensity_max;
+        /// stored meta keys of features, subordinates and dataprocessing entries and their types
+        std::map<String, DataValue::DataType> feature_meta_keys, subordinate_meta_keys, dataprocessing_meta_keys;
+      };
+
+      /**
+        @brief Core fields of all features of a featureSQL file, one array per field (see readColumns())
+
+        Element i of every array belongs to the same feature. Features are in the order of read().
+      */
+      struct OPENMS_DLLAPI FeatureColumns
+      {
+        /// unique IDs as returned by read()
+        std::vector<UInt64> id;
+        std::vector<double> rt;
+        std::vector<double> mz;
+        std::vector<double> intensity;
+        std::vector<Int> charge;
+        std::vector<double> quality;
+      };
+
+      /**
+        @brief Entry of the runs catalog of a multi-run featureSQL file (see writeRun())
+      */
+      struct OPENMS_DLLAPI RunInfo
+      {
+        RunInfo();
+
+        /// ID of the run within the file, as returned by writeRun()
+        Size run_id;
+        /// unique ID of the stored FeatureMap
+        UInt64 map_id;
+        /// identifier of the stored FeatureMap
+        String identifier;
+        /// primary MS run path of the stored FeatureMap
+        StringList primary_ms_run_path;
+        /// number of features of the run
+        Size features;
+      };
+
+      /**
+        @brief Feature matching a query mass of searchMZ()
+      */
+      struct OPENMS_DLLAPI MZHit
+      {
+        MZHit();
+
+        /// file the feature is stored in
+        String file;
+        /// position of the matched mass in the query masses
+        Size query;
+        /// unique ID of the feature (as returned by read())
+        UInt64 id;
+        double rt;
+        double mz;
+        double intensity;
+        Int charge;
+      };
+
+      /**
+        @brief Writes a featureSQL file feature by feature, e.g. directly from a feature finder
+
+        Consumed features are converted into rows and inserted in batches, so memory does not grow with
+        the number of features. Columns of new meta keys and the tables of subordinates and convex hulls
+        are added when they first occur. Everything is written in a single transaction committed by close();
+        nothing is stored if the writer is destroyed before. For complete maps write() is faster, as it
+        converts features in parallel.
+
+        @code
+        FeatureSQLFile::Writer writer;
+        writer.open("features.featureSQL", map_header);
+        writer.consume(feature); // for every feature found
+        writer.close();
+        @endcode
+      */
+      class OPENMS_DLLAPI Writer
+      {
+        public:
+          Writer();
+          ~Writer();
+
+          /**
+            @brief Creates the file @p out_fm (as write() does), replacing an existing one
+
+            Columns are created for the meta keys of the features of @p schema, which are not stored.
+            The unique ID and dataprocessing entries of @p schema are stored by close().
+            Throws Exception::IllegalArgument if the writer is already open.
+          */
+          void open(const std::string& out_fm, const FeatureMap& schema = FeatureMap(), const WriteOptions& options = WriteOptions());
+
+          /// stores @p feature with its subordinates and convex hulls, throws Exception::IllegalArgument if not open
+          void consume(const Feature& feature);
+
+          /// stores the remaining features and the dataprocessing entries, builds the indices and commits the file
+          void close();
+
+        private:
+          Writer(const Writer&) = delete;
+          Writer& operator=(const Writer&) = delete;
+
+          struct Impl;
+          std::unique_ptr<Impl> impl_;
+      };
+
+      void write(const std::string& out_fm, const FeatureMap& fm, const WriteOptions& options = WriteOptions()) const;
+      FeatureMap read(const std::string& in_featureSQL, const ReadOptions& options = ReadOptions()) const;
+
+      /**
+        @brief Adds the features of @p fm to an existing featureSQL file
+
+        Tables missing in the file are created and columns of meta keys not stored before are added,
+        so no stored row is rewritten. Features already present (same unique ID) are rejected with
+        Exception::IllegalArgument and nothing is appended. Dataprocessing entries of @p fm are not stored.
+        Throws Exception::FileNotFound if @p in_featureSQL does not exist.
+      */
+      void append(const std::string& in_featureSQL, const FeatureMap& fm) const;
+
+      /**
+        @brief Overwrites RT, m/z, intensity, charge, quality and meta values of stored features
+
+        Features are matched by their unique ID, throws Exception::IllegalArgument (and changes nothing)
+        if one is not stored (or, in multi-run files, is stored for several runs). Meta keys not present
+        in the file are added as columns; meta values a feature of @p fm lacks are set to NULL for the keys
+        used in @p fm. Subordinates and convex hulls are left unchanged.
+        Throws Exception::FileNotFound if @p in_featureSQL does not exist.
+      */
+      void update(const std::string& in_featureSQL, const FeatureMap& fm) const;
+
+      /**
+        @brief Returns counts, ranges and meta keys of a featureSQL file without reading any feature
+
+        The summary is written by write() to a small table, so only a single row and the meta key catalog
+        are read. append(), writeRun() and update() extend it by the written features instead of rescanning
+        the file, so after update() the ranges may still include replaced values. For older files without
+        this table it is computed from the stored features. Throws Exception::FileNotFound if @p in_featureSQL
+        does not exist.
+      */
+      Summary stat(const std::string& in_featureSQL) const;
+
+      /**
+        @brief Reads ID, RT, m/z, intensity, charge and quality of all features into contiguous arrays
+
+        Only FEATURES_TABLE is scanned and no Feature (or meta value) is constructed, so this needs
+        about 44 bytes per feature. Arrays are reserved to the stored number of features beforehand.
+      */
+      FeatureColumns readColumns(const std::string& in_featureSQL) const;
+
+      /**
+        @brief Reads the features of a featureSQL file one by one
+
+        Features are passed to @p consumer in order of their (stored) IDs as soon as all of their rows
+        have been read, so only a single feature is kept in memory. Dataprocessing entries are not read.
+      */
+      void readStreaming(const std::string& in_featureSQL, const FeatureConsumer& consumer, const ReadOptions& options = ReadOptions()) const;
+
+      /**
+        @brief Reads only the features whose extent intersects the given RT/m/z window
+
+        The extent of a feature is the union of its convex hull boundingboxes (its position if it has none).
+        Candidates are looked up in the region index written by write(), so only matching features
+        (with their subordinates) are decoded. Dataprocessing entries are read as well.
+      */
+      FeatureMap readRegion(const std::string& in_featureSQL, double rt_min, double rt_max, double mz_min, double mz_max, const ReadOptions& options = ReadOptions()) const;
+
+      /**
+        @brief Reads the features with the given unique IDs in the order of @p ids
+
+        The requested IDs are joined with the primary key of the features and the REF_ID indices of the dependent
+        tables, so only these features (with their subordinates and convex hulls) are read. IDs not stored are
+        skipped, IDs requested repeatedly yield a copy each. In multi-run files (see writeRun()) an ID yields the features
+        of all runs storing it, in the order the runs were written. Dataprocessing entries are read as well.
+      */
+      FeatureMap readByIds(const std::string& in_featureSQL, const std::vector<UInt64>& ids, const ReadOptions& options = ReadOptions()) const;
+
+      /**
+        @brief Adds @p fm as a new run to a multi-run featureSQL file, which is created if missing
+
+        All runs share the feature tables, so features of many runs can be queried in one database. Features are stored
+        by a row key of the file and carry the ID of their run, their unique IDs are keyed by (feature ID, run ID),
+        so runs are independent and may reuse feature IDs. Identifier, primary MS run path and dataprocessing
+        entries of @p fm are stored in the runs catalog.
+        Throws Exception::IllegalArgument (and stores nothing) for a file written by write() or a feature ID
+        stored twice in @p fm.
+        append() rejects multi-run files, update() changes features whose ID is stored for a single run.
+
+        @return ID of the new run
+      */
+      Size writeRun(const std::string& in_featureSQL, const FeatureMap& fm) const;
+
+      /**
+        @brief Returns the runs catalog of a multi-run featureSQL file (empty for other files)
+
+        Throws Exception::FileNotFound if @p in_featureSQL does not exist.
+      */
+      std::vector<RunInfo> readRunCatalog(const std::string& in_featureSQL) const;
+
+      /**
+        @brief Reads the runs @p run_ids of a multi-run featureSQL file, one FeatureMap per requested run
+
+        Maps get unique ID, identifier, primary MS run path and (if requested) dataprocessing entries of their run.
+        Only the rows of the requested runs are read, through the (run ID, feature ID) index.
+        Throws Exception::IllegalArgument if the file has no runs catalog or a run is not stored.
+      */
+      std::vector<FeatureMap> readRuns(const std::string& in_featureSQL, const std::vector<Size>& run_ids, const ReadOptions& options = ReadOptions()) const;
+
+      /**
+        @brief Finds the features within @p ppm of any of the masses @p mzs in one or many featureSQL files
+
+        The query masses are sorted and searched in a single ordered scan per file, which visits only the
+        (merged) tolerance windows of the m/z index built at write time; files written without it are scanned
+        over the span of all windows. Only FEATURES_TABLE is read and no Feature is constructed.
+        Optionally, features are restricted to the RT window [@p rt_min, @p rt_max]. Files are searched concurrently.
+
+        @return one hit per matching pair of feature and query mass, files in the given order, ascending by m/z within a file
+
+        Throws Exception::FileNotFound if a file does not exist and Exception::IllegalArgument for a negative @p ppm.
+      */
+      std::vector<MZHit> searchMZ(const std::vector<std::string>& in_featureSQLs, const std::vector<double>& mzs, double ppm,
+                                  double rt_min = -std::numeric_limits<double>::max(), double rt_max = std::numeric_limits<double>::max()) const;
   };
 
 } // namespace OpenMS
@@ -0,0 +1,263 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2018.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Matthias Fuchs $
+// $Authors: Matthias Fuchs $
+// --------------------------------------------------------------------------
+
+// Benchmark of FeatureSQLFile against FeatureXMLFile on synthetic feature maps.
+//
+// usage: FeatureSQLFile_benchmark [features] [subordinates] [hulls] [meta_keys] [xml_file] [type_mix]
+//   features      number of features (default 100000)
+//   subordinates  subordinates per feature (default 2)
+//   hulls         convex hulls per feature and subordinate (default 1)
+//   meta_keys     meta values per feature (default 12)
+//   xml_file      featureXML output (default FeatureSQLFile_benchmark.featureXML)
+//   type_mix      comma separated weights of the meta value types int, double, string,
+//                 int list, double list and string list, e.g. 0,2,1 for two double keys
+//                 per string key (default 1,1,1,1,1,1, missing weights are 0)
+//
+// The benchmark has no build target, compile it against the OpenMS library like a class test.
+//
+// For each format, the time of writing and reading, the throughput (features/s),
+// the peak resident set size during each step (including the synthetic input map)
+// and the size of the files are reported.
+
+#include <OpenMS/FORMAT/FeatureSQLFile.h>
+#include <OpenMS/FORMAT/FeatureXMLFile.h>
+#include <OpenMS/KERNEL/FeatureMap.h>
+#include <OpenMS/SYSTEM/File.h>
+#include <OpenMS/SYSTEM/StopWatch.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+using namespace OpenMS;
+using namespace std;
+
+namespace
+{
+  struct Result
+  {
+    double seconds = 0.0;
+    Size peak_rss_kb = 0;
+  };
+
+  // reset the peak resident set size (VmHWM) of the process, Linux only
+  void resetPeakRSS()
+  {
+    ofstream clear_refs("/proc/self/clear_refs");
+    clear_refs << "5";
+  }
+
+  // peak resident set size since last resetPeakRSS() in KiB, 0 if unknown
+  Size peakRSS()
+  {
+    ifstream status("/proc/self/status");
+    string line;
+    while (getline(status, line))
+    {
+      if (line.compare(0, 6, "VmHWM:") == 0)
+      {
+        return strtoul(line.c_str() + 6, nullptr, 10);
+      }
+    }
+    return 0;
+  }
+
+  Size fileSize(const String& filename)
+  {
+    ifstream in(filename.c_str(), ios::binary | ios::ate);
+    return in ? static_cast<Size>(in.tellg()) : 0;
+  }
+
+  Result measure(const function<void()>& step)
+  {
+    resetPeakRSS();
+    StopWatch sw;
+    sw.start();
+    step();
+    sw.stop();
+    Result result;
+    result.seconds = sw.getClockTime();
+    result.peak_rss_kb = peakRSS();
+    return result;
+  }
+
+  // meta value types in the order of the type_mix weights
+  const Size n_types = 6;
+
+  // type of each meta key: the types repeated by their weight, cycled through by the keys
+  vector<Size> metaKeyTypes(const String& type_mix, Size n_meta_keys)
+  {
+    vector<Size> pattern;
+    istringstream weights(type_mix);
+    string weight;
+    for (Size type = 0; type < n_types && getline(weights, weight, ','); ++type)
+    {
+      pattern.insert(pattern.end(), strtoul(weight.c_str(), nullptr, 10), type);
+    }
+    if (pattern.empty() && n_meta_keys > 0)
+    {
+      cerr << "type_mix '" << type_mix << "' has no positive weight" << endl;
+      exit(EXIT_FAILURE);
+    }
+    vector<Size> types;
+    for (Size k = 0; k < n_meta_keys; ++k)
+    {
+      types.push_back(pattern[k % pattern.size()]);
+    }
+    return types;
+  }
+
+  // random meta value of a type of metaKeyTypes()
+  DataValue metaValue(Size type, mt19937& rng)
+  {
+    uniform_real_distribution<double> real(0.0, 1000.0);
+    uniform_int_distribution<int> integer(-1000, 1000);
+    switch (type)
+    {
+      case 0:
+        return DataValue(integer(rng));
+      case 1:
+        return DataValue(real(rng));
+      case 2:
+        return DataValue(String("value_") + String(integer(rng)));
+      case 3:
+        return DataValue(IntList{integer(rng), integer(rng), integer(rng)});
+      case 4:
+        return DataValue(DoubleList{real(rng), real(rng), real(rng), real(rng), real(rng), real(rng)});
+      default:
+        return DataValue(StringList{"isotope_" + String(integer(rng)), "trace_" + String(integer(rng))});
+    }
+  }
+
+  void addHulls(Feature& feature, Size n_hulls)
+  {
+    for (Size h = 0; h < n_hulls; ++h)
+    {
+      ConvexHull2D hull;
+      hull.addPoint({feature.getRT() - 5.0 + h, feature.getMZ() - 0.01});
+      hull.addPoint({feature.getRT() + 5.0 + h, feature.getMZ() + 0.01});
+      feature.getConvexHulls().push_back(hull);
+    }
+  }
+
+  FeatureMap syntheticMap(Size n_features, Size n_subordinates, Size n_hulls, const vector<Size>& meta_key_types)
+  {
+    mt19937 rng(42);
+    uniform_real_distribution<double> rt(0.0, 3600.0);
+    uniform_real_distribution<double> mz(100.0, 2000.0);
+    uniform_real_distribution<double> intensity(1e3, 1e8);
+
+    FeatureMap feature_map;
+    feature_map.reserve(n_features);
+    for (Size i = 0; i < n_features; ++i)
+    {
+      Feature feature;
+      feature.setUniqueId();
+      feature.setRT(rt(rng));
+      feature.setMZ(mz(rng));
+      feature.setIntensity(intensity(rng));
+      feature.setCharge(1 + i % 4);
+      feature.setOverallQuality(0.5);
+      for (Size k = 0; k < meta_key_types.size(); ++k)
+      {
+        feature.setMetaValue("key_" + String(k), metaValue(meta_key_types[k], rng));
+      }
+      addHulls(feature, n_hulls);
+
+      for (Size s = 0; s < n_subordinates; ++s)
+      {
+        Feature subordinate;
+        subordinate.setUniqueId();
+        subordinate.setRT(feature.getRT());
+        subordinate.setMZ(feature.getMZ() + (s + 1) * 1.003355 / feature.getCharge());
+        subordinate.setIntensity(feature.getIntensity() / (s + 2));
+        subordinate.setMetaValue("isotope", static_cast<int>(s + 1));
+        addHulls(subordinate, n_hulls);
+        feature.getSubordinates().push_back(subordinate);
+      }
+      feature_map.push_back(feature);
+    }
+    feature_map.ensureUniqueId();
+    return feature_map;
+  }
+
+  void report(const String& format, const String& step, const Result& result, Size n_features)
+  {
+    cout << setw(22) << format << setw(8) << step
+         << setw(12) << fixed << setprecision(3) << result.seconds
+         << setw(16) << setprecision(0) << (result.seconds > 0.0 ? n_features / result.seconds : 0.0)
+         << setw(16) << setprecision(1) << result.peak_rss_kb / 1024.0 << endl;
+  }
+}
+
+int main(int argc, const char** argv)
+{
+  const Size n_features = argc > 1 ? strtoul(argv[1], nullptr, 10) : 100000;
+  const Size n_subordinates = argc > 2 ? strtoul(argv[2], nullptr, 10) : 2;
+  const Size n_hulls = argc > 3 ? strtoul(argv[3], nullptr, 10) : 1;
+  const Size n_meta_keys = argc > 4 ? strtoul(argv[4], nullptr, 10) : 12;
+  const String xml_file = argc > 5 ? String(argv[5]) : String("FeatureSQLFile_benchmark.featureXML");
+  const String type_mix = argc > 6 ? String(argv[6]) : String("1,1,1,1,1,1");
+  const String sql_name = "FeatureSQLFile_benchmark.sqlite";
+
+  const FeatureMap feature_map = syntheticMap(n_features, n_subordinates, n_hulls, metaKeyTypes(type_mix, n_meta_keys));
+  cout << n_features << " features, " << n_subordinates << " subordinates, " << n_hulls << " hulls, " << n_meta_keys
+       << " meta keys (type mix " << type_mix << ")" << endl;
+  cout << setw(22) << "format" << setw(8) << "step" << setw(12) << "time [s]" << setw(16) << "features/s" << setw(16) << "peak RSS [MiB]" << endl;
+
+  FeatureXMLFile xml;
+  report("featureXML", "write", measure([&]() { xml.store(xml_file, feature_map); }), n_features);
+  report("featureXML", "read", measure([&]() { FeatureMap loaded; xml.load(xml_file, loaded); }), n_features);
+
+  FeatureSQLFile sql;
+  const String profile_names[FeatureSQLFile::SIZE_OF_WRITEPROFILE] = {"default", "bulk-load", "durable", "in-memory"};
+  for (Size p = 0; p < FeatureSQLFile::SIZE_OF_WRITEPROFILE; ++p)
+  {
+    FeatureSQLFile::WriteOptions options;
+    options.profile = static_cast<FeatureSQLFile::WriteProfile>(p);
+    report("featureSQL/" + profile_names[p], "write", measure([&]() { sql.write(sql_name, feature_map, options); }), n_features);
+  }
+  report("featureSQL", "read", measure([&]() { FeatureMap loaded = sql.read(sql_name); }), n_features);
+
+  cout << "file size [MiB]: featureXML " << fixed << setprecision(1) << fileSize(xml_file) / 1048576.0
+       << ", featureSQL " << fileSize(sql_name) / 1048576.0 << endl;
+
+  File::remove(xml_file);
+  File::remove(sql_name);
+  return EXIT_SUCCESS;
+}
@@ -44,6 +44,7 @@
 #include <OpenMS/METADATA/DataProcessing.h>
 #include <OpenMS/METADATA/ProteinIdentification.h>
 #include <OpenMS/METADATA/PeptideIdentification.h>
+#include <OpenMS/SYSTEM/File.h>
 
 #include <algorithm>
 #include <string>
@@ -56,6 +57,66 @@ using namespace OpenMS;
 
 ///////////////////////////
 
+// features of the reference featureXML file written to the featureSQL file filename, as read back (ordered by ID)
+FeatureMap writeReference(const std::string& filename)
+{
+  FeatureMap reference;
+  FeatureXMLFile().load(OPENMS_GET_TEST_DATA_PATH("MetaboIdent_1_output.featureXML"), reference);
+  FeatureSQLFile fsf;
+  fsf.write(filename, reference);
+  return fsf.read(filename);
+}
+
+// featureSQL file filename of a feature (ID 1) with a feature (ID 2) appended, which adds a meta key, a subordinate and a convex hull
+void writeAppended(const std::string& filename)
+{
+  Feature feature;
+  feature.setUniqueId(1);
+  feature.setRT(10.0);
+  feature.setMZ(500.0);
+  feature.setMetaValue("label", "first");
+  FeatureMap map;
+  map.push_back(feature);
+  FeatureSQLFile fsf;
+  fsf.write(filename, map);
+
+  Feature subordinate;
+  subordinate.setUniqueId(3);
+  subordinate.setMetaValue("isotope", 1);
+  ConvexHull2D hull;
+  hull.addPoint({20.0, 600.0});
+  hull.addPoint({25.0, 601.0});
+  Feature feature2;
+  feature2.setUniqueId(2);
+  feature2.setRT(22.0);
+  feature2.setMZ(600.5);
+  feature2.setMetaValue("label", "second");
+  feature2.setMetaValue("score", 0.5);
+  feature2.getConvexHulls().push_back(hull);
+  feature2.getSubordinates().push_back(subordinate);
+  FeatureMap chunk;
+  chunk.push_back(feature2);
+  fsf.append(filename, chunk);
+}
+
+// first and second half of the reference features as two runs with their metadata
+vector<FeatureMap> referenceRuns(const FeatureMap& reference)
+{
+  vector<FeatureMap> runs(2);
+  runs[0].insert(runs[0].end(), reference.begin(), reference.begin() + reference.size() / 2);
+  runs[1].insert(runs[1].end(), reference.begin() + reference.size() / 2, reference.end());
+  runs[0].setUniqueId(11);
+  runs[0].setIdentifier("run_1");
+  runs[0].setPrimaryMSRunPath({"run_1.mzML"});
+  runs[0].getDataProcessing().resize(2);
+  runs[0].getDataProcessing()[1].setMetaValue("parameter", 3);
+  runs[0].getDataProcessing()[0].setMetaValue("parameter: a:b", "on");
+  runs[1].setUniqueId(12);
+  runs[1].setIdentifier("run_2");
+  runs[1].setPrimaryMSRunPath({"run_2a.mzML", "run_2b.mzML"});
+  return runs;
+}
+
 /////////////////////////////////////////////////////////////
 
 START_TEST(FeatureMap, "$Id$")
@@ -146,6 +207,25 @@ START_SECTION((void write(std::string& out_fm, FeatureMap& feature_map)))
   FeatureSQLFile fsf;
   fsf.write("test", e2);
 
+  // several dataprocessing entries with different userparams
+  map1[0].setUniqueId(1);
+  map1[1].setUniqueId(2);
+  map1.getDataProcessing().resize(2);
+  map1.getDataProcessing()[0].getSoftware().setName("FeatureFinder");
+  map1.getDataProcessing()[0].setMetaValue("threshold", 0.5);
+  map1.getDataProcessing()[1].getSoftware().setName("MapAligner");
+  map1.getDataProcessing()[1].setMetaValue("model", "linear");
+  std::string tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+  fsf.write(tmp_filename, map1);
+  FeatureMap output = fsf.read(tmp_filename);
+  ABORT_IF(output.getDataProcessing().size() != 2)
+  TEST_EQUAL(output.getDataProcessing()[0].getSoftware().getName(), "FeatureFinder")
+  TEST_REAL_SIMILAR(output.getDataProcessing()[0].getMetaValue("threshold"), 0.5)
+  TEST_EQUAL(output.getDataProcessing()[0].metaValueExists("model"), false)
+  TEST_EQUAL(output.getDataProcessing()[1].getSoftware().getName(), "MapAligner")
+  TEST_EQUAL(output.getDataProcessing()[1].getMetaValue("model"), "linear")
+  TEST_EQUAL(output.getDataProcessing()[1].metaValueExists("threshold"), false)
 }
 END_SECTION
 
@@ -175,6 +255,1114 @@ START_SECTION((FeatureMap read(std::string& in_featureSQL)))
 }
 END_SECTION
 
+START_SECTION((void write(const std::string& out_fm, const FeatureMap& fm, const WriteOptions& options) const))
+{
+  std::string profile_file;
+  NEW_TMP_FILE(profile_file);
+  FeatureSQLFile fsf;
+  std::string reference_file;
+  NEW_TMP_FILE(reference_file);
+  FeatureMap expected = writeReference(reference_file);
+
+  FeatureSQLFile::WriteOptions options;
+  for (Size p = 0; p < FeatureSQLFile::SIZE_OF_WRITEPROFILE; ++p)
+  {
+    options.profile = static_cast<FeatureSQLFile::WriteProfile>(p);
+    fsf.write(profile_file, expected, options);
+    FeatureMap output = fsf.read(profile_file);
+    TEST_EQUAL(output.size(), expected.size())
+    TEST_EQUAL(output.getDataProcessing().size(), expected.getDataProcessing().size())
+    ABORT_IF(output.size() != expected.size())
+    for (Size i = 0; i < output.size(); ++i)
+    {
+      TEST_EQUAL(output[i].getUniqueId(), expected[i].getUniqueId())
+      TEST_EQUAL(output[i].getSubordinates().size(), expected[i].getSubordinates().size())
+    }
+  }
+}
+END_SECTION
+
+START_SECTION((subordinates with several convex hulls))
+{
+  std::string hulls_file;
+  NEW_TMP_FILE(hulls_file);
+  Feature subordinate;
+  subordinate.setUniqueId(2);
+  for (Size h = 0; h < 3; ++h)
+  {
+    ConvexHull2D hull;
+    hull.addPoint({10.0 * h, 100.0});
+    hull.addPoint({10.0 * h + 5.0, 101.0});
+    subordinate.getConvexHulls().push_back(hull);
+  }
+  Feature feature;
+  feature.setUniqueId(1);
+  feature.getSubordinates().push_back(subordinate);
+  // same subordinate ID below another feature
+  Feature feature2;
+  feature2.setUniqueId(3);
+  feature2.getSubordinates().push_back(subordinate);
+  FeatureMap map;
+  map.push_back(feature);
+  map.push_back(feature2);
+
+  FeatureSQLFile fsf;
+  fsf.write(hulls_file, map);
+  FeatureMap output = fsf.read(hulls_file);
+  TEST_EQUAL(output.size(), 2)
+  ABORT_IF(output.size() != 2)
+  for (const Feature& f : output)
+  {
+    ABORT_IF(f.getSubordinates().size() != 1)
+    TEST_EQUAL(f.getSubordinates()[0].getConvexHulls().size(), 3)
+    TEST_REAL_SIMILAR(f.getSubordinates()[0].getConvexHulls()[2].getBoundingBox().minX(), 20.0)
+  }
+
+  // hulls stay with their subordinate if subordinates of a feature share an ID (or keep the default 0)
+  Feature shared;
+  shared.setUniqueId(5);
+  for (Size s = 0; s < 4; ++s)
+  {
+    Feature sub;
+    sub.setUniqueId(s < 3 ? 0 : 7);
+    ConvexHull2D hull;
+    hull.addPoint({10.0 * s, 100.0});
+    hull.addPoint({10.0 * s + 5.0, 101.0});
+    sub.getConvexHulls().push_back(hull);
+    shared.getSubordinates().push_back(sub);
+  }
+  shared.getSubordinates()[3].getConvexHulls().push_back(shared.getSubordinates()[3].getConvexHulls()[0]);
+  Feature shared2 = shared;
+  shared2.setUniqueId(6);
+  for (Feature& sub : shared2.getSubordinates())
+  {
+    sub.setUniqueId(7);
+  }
+  FeatureMap shared_map;
+  shared_map.push_back(shared);
+  shared_map.push_back(shared2);
+  fsf.write(hulls_file, shared_map);
+  output = fsf.read(hulls_file);
+  ABORT_IF(output.size() != 2)
+  for (const Feature& f : output)
+  {
+    ABORT_IF(f.getSubordinates().size() != 4)
+    for (Size s = 0; s < 4; ++s)
+    {
+      TEST_EQUAL(f.getSubordinates()[s].getConvexHulls().size(), s < 3 ? 1 : 2)
+      TEST_REAL_SIMILAR(f.getSubordinates()[s].getConvexHulls()[0].getBoundingBox().minX(), 10.0 * s)
+    }
+  }
+}
+END_SECTION
+
+START_SECTION((FeatureMap read(const std::string& in_featureSQL, const ReadOptions& options) const))
+{
+  FeatureSQLFile fsf;
+  std::string reference_file;
+  NEW_TMP_FILE(reference_file);
+  FeatureMap all = writeReference(reference_file);
+  ABORT_IF(all.empty())
+
+  // core fields and a single meta key
+  vector<String> keys;
+  all[0].getKeys(keys);
+  ABORT_IF(keys.empty())
+  FeatureSQLFile::ReadOptions options;
+  options.all_meta_values = false;
+  options.meta_keys.insert(keys[0]);
+  options.subordinates = false;
+  options.convex_hulls = false;
+  options.dataprocessing = false;
+  FeatureMap projected = fsf.read(reference_file, options);
+
+  TEST_EQUAL(projected.size(), all.size())
+  TEST_EQUAL(projected.getDataProcessing().size(), 0)
+  TEST_EQUAL(projected[0].getUniqueId(), all[0].getUniqueId())
+  TEST_REAL_SIMILAR(projected[0].getRT(), all[0].getRT())
+  TEST_REAL_SIMILAR(projected[0].getMZ(), all[0].getMZ())
+  TEST_REAL_SIMILAR(projected[0].getIntensity(), all[0].getIntensity())
+  TEST_EQUAL(projected[0].getCharge(), all[0].getCharge())
+  TEST_EQUAL(projected[0].getSubordinates().size(), 0)
+  TEST_EQUAL(projected[0].getConvexHulls().size(), 0)
+  vector<String> projected_keys;
+  projected[0].getKeys(projected_keys);
+  TEST_EQUAL(projected_keys.size(), 1)
+  TEST_EQUAL(projected[0].getMetaValue(keys[0]) == all[0].getMetaValue(keys[0]), true)
+
+  // no meta values at all
+  options.meta_keys.clear();
+  projected = fsf.read(reference_file, options);
+  projected[0].getKeys(projected_keys);
+  TEST_EQUAL(projected_keys.size(), 0)
+}
+END_SECTION
+
+START_SECTION((list meta values are stored as binary BLOBs))
+{
+  std::string lists_file;
+  NEW_TMP_FILE(lists_file);
+  Feature feature;
+  feature.setUniqueId(1);
+  feature.setMetaValue("masses", DoubleList{1.0 / 3.0, 1e-300, -2.5});
+  feature.setMetaValue("charges", IntList{-2, 0, 2147483647});
+  feature.setMetaValue("names", StringList{"a, b", "", "c"});
+  feature.setMetaValue("empty", DoubleList());
+  FeatureMap map;
+  map.push_back(feature);
+
+  FeatureSQLFile fsf;
+  fsf.write(lists_file, map);
+  FeatureMap output = fsf.read(lists_file);
+  ABORT_IF(output.size() != 1)
+
+  DoubleList masses = output[0].getMetaValue("masses").toDoubleList();
+  ABORT_IF(masses.size() != 3)
+  // no precision is lost by a text rendering
+  TEST_EQUAL(masses[0] == 1.0 / 3.0, true)
+  TEST_EQUAL(masses[1] == 1e-300, true)
+  TEST_EQUAL(masses[2] == -2.5, true)
+  TEST_EQUAL(output[0].getMetaValue("charges") == feature.getMetaValue("charges"), true)
+  TEST_EQUAL(output[0].getMetaValue("names").toStringList().size(), 3)
+  TEST_EQUAL(output[0].getMetaValue("names").toStringList()[0], "a, b")
+  TEST_EQUAL(output[0].getMetaValue("empty").toDoubleList().size(), 0)
+}
+END_SECTION
+
+START_SECTION((void readStreaming(const std::string& in_featureSQL, const FeatureConsumer& consumer) const))
+{
+  FeatureSQLFile fsf;
+  std::string reference_file;
+  NEW_TMP_FILE(reference_file);
+  FeatureMap expected = writeReference(reference_file);
+
+  Size count = 0;
+  fsf.readStreaming(reference_file, [&](Feature& feature)
+  {
+    TEST_EQUAL(feature.getUniqueId(), expected[count].getUniqueId())
+    TEST_REAL_SIMILAR(feature.getRT(), expected[count].getRT())
+    TEST_EQUAL(feature.getSubordinates().size(), expected[count].getSubordinates().size())
+    TEST_EQUAL(feature.getConvexHulls().size(), expected[count].getConvexHulls().size())
+    ++count;
+  });
+  TEST_EQUAL(count, expected.size())
+}
+END_SECTION
+
+START_SECTION((FeatureMap readRegion(const std::string& in_featureSQL, double rt_min, double rt_max, double mz_min, double mz_max) const))
+{
+  FeatureSQLFile fsf;
+  std::string reference_file;
+  NEW_TMP_FILE(reference_file);
+  FeatureMap all = writeReference(reference_file);
+  ABORT_IF(all.empty())
+
+  // window around the position of the first feature
+  const Feature& target = all[0];
+  double rt_min = target.getRT() - 1.0;
+  double rt_max = target.getRT() + 1.0;
+  double mz_min = target.getMZ() - 0.01;
+  double mz_max = target.getMZ() + 0.01;
+  FeatureMap region = fsf.readRegion(reference_file, rt_min, rt_max, mz_min, mz_max);
+  TEST_EQUAL(region.size() <= all.size(), true)
+
+  bool found = false;
+  for (const Feature& feature : region)
+  {
+    if (feature.getUniqueId() == target.getUniqueId())
+    {
+      found = true;
+      TEST_EQUAL(feature.getSubordinates().size(), target.getSubordinates().size())
+      TEST_EQUAL(feature.getConvexHulls().size(), target.getConvexHulls().size())
+    }
+  }
+  TEST_EQUAL(found, true)
+
+  // window outside of any feature
+  TEST_EQUAL(fsf.readRegion(reference_file, -20.0, -10.0, -20.0, -10.0).size(), 0)
+}
+END_SECTION
+
+START_SECTION((void append(const std::string& in_featureSQL, const FeatureMap& fm) const))
+{
+  std::string append_file;
+  NEW_TMP_FILE(append_file);
+  Feature feature;
+  feature.setUniqueId(1);
+  feature.setRT(10.0);
+  feature.setMZ(500.0);
+  feature.setMetaValue("label", "first");
+  FeatureMap map;
+  map.push_back(feature);
+  FeatureSQLFile fsf;
+  fsf.write(append_file, map);
+
+  // new meta key, subordinates and convex hulls in the appended chunk
+  Feature subordinate;
+  subordinate.setUniqueId(3);
+  subordinate.setMetaValue("isotope", 1);
+  ConvexHull2D hull;
+  hull.addPoint({20.0, 600.0});
+  hull.addPoint({25.0, 601.0});
+  Feature feature2;
+  feature2.setUniqueId(2);
+  feature2.setRT(22.0);
+  feature2.setMZ(600.5);
+  feature2.setMetaValue("label", "second");
+  feature2.setMetaValue("score", 0.5);
+  feature2.getConvexHulls().push_back(hull);
+  feature2.getSubordinates().push_back(subordinate);
+  FeatureMap chunk;
+  chunk.push_back(feature2);
+  fsf.append(append_file, chunk);
+
+  FeatureMap output = fsf.read(append_file);
+  TEST_EQUAL(output.size(), 2)
+  ABORT_IF(output.size() != 2)
+  TEST_EQUAL(output[0].getMetaValue("label"), "first")
+  TEST_EQUAL(output[0].metaValueExists("score"), false)
+  TEST_EQUAL(output[1].getMetaValue("label"), "second")
+  TEST_REAL_SIMILAR(output[1].getMetaValue("score"), 0.5)
+  TEST_EQUAL(output[1].getConvexHulls().size(), 1)
+  ABORT_IF(output[1].getSubordinates().size() != 1)
+  TEST_EQUAL(int(output[1].getSubordinates()[0].getMetaValue("isotope")), 1)
+  TEST_EQUAL(fsf.readRegion(append_file, 21.0, 23.0, 600.0, 601.0).size(), 1)
+
+  // stored IDs are rejected, nothing is appended
+  feature2.setUniqueId(4);
+  chunk.push_back(feature);
+  chunk[0] = feature2;
+  TEST_EXCEPTION(Exception::IllegalArgument, fsf.append(append_file, chunk))
+  TEST_EQUAL(fsf.read(append_file).size(), 2)
+
+  // a meta key stored with another type cannot be appended
+  chunk.clear();
+  feature2.setMetaValue("score", "high");
+  chunk.push_back(feature2);
+  TEST_EXCEPTION(Exception::IllegalArgument, fsf.append(append_file, chunk))
+
+  // a missing file is not created
+  std::string missing_file;
+  NEW_TMP_FILE(missing_file);
+  TEST_EXCEPTION(Exception::FileNotFound, fsf.append(missing_file, chunk))
+  TEST_EQUAL(File::exists(missing_file), false)
+
+  // meta keys are stored as delimited identifiers, whatever characters they contain
+  Feature feature5;
+  feature5.setUniqueId(5);
+  feature5.setMetaValue("origin: \"raw\", 1", "appended");
+  feature5.setMetaValue("weight (a:b)", 2.5);
+  chunk.clear();
+  chunk.push_back(feature5);
+  fsf.append(append_file, chunk);
+  output = fsf.read(append_file);
+  ABORT_IF(output.size() != 3)
+  TEST_EQUAL(output[2].getMetaValue("origin: \"raw\", 1"), "appended")
+  TEST_REAL_SIMILAR(output[2].getMetaValue("weight (a:b)"), 2.5)
+  TEST_EQUAL(output[0].metaValueExists("weight (a:b)"), false)
+}
+END_SECTION
+
+START_SECTION((void update(const std::string& in_featureSQL, const FeatureMap& fm) const))
+{
+  std::string append_file;
+  NEW_TMP_FILE(append_file);
+  writeAppended(append_file);
+  FeatureSQLFile fsf;
+  FeatureMap map = fsf.read(append_file);
+  ABORT_IF(map.size() != 2)
+
+  // requantification of the first feature
+  FeatureMap requantified;
+  requantified.push_back(map[0]);
+  requantified[0].setIntensity(1234.5);
+  requantified[0].setRT(40.0);
+  requantified[0].setMetaValue("requantified", 1);
+  fsf.update(append_file, requantified);
+
+  FeatureMap output = fsf.read(append_file);
+  ABORT_IF(output.size() != 2)
+  TEST_REAL_SIMILAR(output[0].getIntensity(), 1234.5)
+  TEST_REAL_SIMILAR(output[0].getRT(), 40.0)
+  TEST_EQUAL(output[0].getMetaValue("label"), "first")
+  TEST_EQUAL(int(output[0].getMetaValue("requantified")), 1)
+  TEST_REAL_SIMILAR(output[1].getIntensity(), map[1].getIntensity())
+  TEST_EQUAL(output[1].getSubordinates().size(), 1)
+  // the region index follows the new position of features without convex hulls
+  TEST_EQUAL(fsf.readRegion(append_file, 39.0, 41.0, 499.0, 501.0).size(), 1)
+  TEST_EQUAL(fsf.readRegion(append_file, 9.0, 11.0, 499.0, 501.0).size(), 0)
+
+  // unknown features are rejected, nothing is updated
+  requantified[0].setIntensity(1.0);
+  Feature unknown;
+  unknown.setUniqueId(99);
+  requantified.push_back(unknown);
+  TEST_EXCEPTION(Exception::IllegalArgument, fsf.update(append_file, requantified))
+  TEST_REAL_SIMILAR(fsf.read(append_file)[0].getIntensity(), 1234.5)
+
+  // meta keys that are no plain SQL identifiers are added and assigned as well
+  requantified.clear();
+  requantified.push_back(map[1]);
+  requantified[0].setMetaValue("requant: \"run\" 2", "yes");
+  fsf.update(append_file, requantified);
+  output = fsf.read(append_file);
+  ABORT_IF(output.size() != 2)
+  TEST_EQUAL(output[1].getMetaValue("requant: \"run\" 2"), "yes")
+  TEST_EQUAL(output[1].getMetaValue("label"), "second")
+
+  // a missing file is not created
+  std::string missing_file;
+  NEW_TMP_FILE(missing_file);
+  TEST_EXCEPTION(Exception::FileNotFound, fsf.update(missing_file, requantified))
+  TEST_EQUAL(File::exists(missing_file), false)
+}
+END_SECTION
+
+START_SECTION((Summary stat(const std::string& in_featureSQL) const))
+{
+  std::string append_file;
+  NEW_TMP_FILE(append_file);
+  std::string stat_file;
+  NEW_TMP_FILE(stat_file);
+  FeatureSQLFile fsf;
+  std::string reference_file;
+  NEW_TMP_FILE(reference_file);
+  FeatureMap map = writeReference(reference_file);
+  map.updateRanges();
+  Size n_subordinates = 0;
+  for (const Feature& feature : map)
+  {
+    n_subordinates += feature.getSubordinates().size();
+  }
+
+  FeatureSQLFile::Summary summary = fsf.stat(reference_file);
+  TEST_EQUAL(summary.schema_version, 1)
+  TEST_EQUAL(summary.features, map.size())
+  TEST_EQUAL(summary.subordinates, n_subordinates)
+  TEST_EQUAL(summary.dataprocessing, map.getDataProcessing().size())
+  TEST_EQUAL(summary.region_index, true)
+  TEST_REAL_SIMILAR(summary.rt_min, map.getMin()[0])
+  TEST_REAL_SIMILAR(summary.rt_max, map.getMax()[0])
+  TEST_REAL_SIMILAR(summary.mz_min, map.getMin()[1])
+  TEST_REAL_SIMILAR(summary.mz_max, map.getMax()[1])
+  TEST_REAL_SIMILAR(summary.intensity_min, map.getMinInt())
+  TEST_REAL_SIMILAR(summary.intensity_max, map.getMaxInt())
+  vector<String> keys;
+  map[0].getKeys(keys);
+  ABORT_IF(keys.empty())
+  TEST_EQUAL(summary.feature_meta_keys.count(keys[0]), 1)
+  TEST_EQUAL(summary.feature_meta_keys[keys[0]], map[0].getMetaValue(keys[0]).valueType())
+
+  // summary is kept up to date by append() and update()
+  writeAppended(append_file);
+  FeatureMap requantified;
+  requantified.push_back(fsf.read(append_file)[0]);
+  requantified[0].setIntensity(1234.5);
+  requantified[0].setRT(40.0);
+  requantified[0].setMetaValue("requantified", 1);
+  fsf.update(append_file, requantified);
+  summary = fsf.stat(append_file);
+  TEST_EQUAL(summary.features, 2)
+  TEST_EQUAL(summary.subordinates, 1)
+  TEST_EQUAL(summary.feature_hulls, 1)
+  TEST_REAL_SIMILAR(summary.rt_max, 40.0)
+  TEST_REAL_SIMILAR(summary.intensity_max, 1234.5)
+  TEST_EQUAL(summary.feature_meta_keys.size(), 3)
+  TEST_EQUAL(summary.subordinate_meta_keys.count("isotope"), 1)
+
+  // append() extends the stored summary, update() does not narrow its ranges
+  fsf.write(stat_file, map);
+  FeatureMap appended;
+  Feature feature;
+  feature.setUniqueId(map.size() + 1000);
+  feature.setRT(map.getMax()[0] + 100.0);
+  feature.setMZ(map.getMin()[1] - 1.0);
+  feature.setIntensity(map.getMaxInt() + 1.0);
+  appended.push_back(feature);
+  fsf.append(stat_file, appended);
+  summary = fsf.stat(stat_file);
+  TEST_EQUAL(summary.features, map.size() + 1)
+  TEST_EQUAL(summary.subordinates, n_subordinates)
+  TEST_REAL_SIMILAR(summary.rt_min, map.getMin()[0])
+  TEST_REAL_SIMILAR(summary.rt_max, map.getMax()[0] + 100.0)
+  TEST_REAL_SIMILAR(summary.mz_min, map.getMin()[1] - 1.0)
+  TEST_REAL_SIMILAR(summary.intensity_max, map.getMaxInt() + 1.0)
+  appended[0].setRT(map.getMin()[0]);
+  fsf.update(stat_file, appended);
+  summary = fsf.stat(stat_file);
+  TEST_EQUAL(summary.features, map.size() + 1)
+  TEST_REAL_SIMILAR(summary.rt_max, map.getMax()[0] + 100.0)
+
+  TEST_EXCEPTION(Exception::FileNotFound, fsf.stat(OPENMS_GET_TEST_DATA_PATH("test_does_not_exist")))
+}
+END_SECTION
+
+START_SECTION((FeatureColumns readColumns(const std::string& in_featureSQL) const))
+{
+  FeatureSQLFile fsf;
+  std::string reference_file;
+  NEW_TMP_FILE(reference_file);
+  FeatureMap map = writeReference(reference_file);
+  FeatureSQLFile::FeatureColumns columns = fsf.readColumns(reference_file);
+  TEST_EQUAL(columns.id.size(), map.size())
+  TEST_EQUAL(columns.rt.size(), map.size())
+  TEST_EQUAL(columns.mz.size(), map.size())
+  TEST_EQUAL(columns.intensity.size(), map.size())
+  TEST_EQUAL(columns.charge.size(), map.size())
+  TEST_EQUAL(columns.quality.size(), map.size())
+  ABORT_IF(columns.id.size() != map.size())
+  for (Size i = 0; i < map.size(); ++i)
+  {
+    TEST_EQUAL(columns.id[i], map[i].getUniqueId())
+    TEST_REAL_SIMILAR(columns.rt[i], map[i].getRT())
+    TEST_REAL_SIMILAR(columns.mz[i], map[i].getMZ())
+    TEST_REAL_SIMILAR(columns.intensity[i], map[i].getIntensity())
+    TEST_EQUAL(columns.charge[i], map[i].getCharge())
+    TEST_REAL_SIMILAR(columns.quality[i], map[i].getOverallQuality())
+  }
+}
+END_SECTION
+
+START_SECTION((filters of ReadOptions))
+{
+  std::string filter_file;
+  NEW_TMP_FILE(filter_file);
+  FeatureMap map;
+  for (Size i = 0; i < 20; ++i)
+  {
+    Feature feature;
+    feature.setUniqueId(i + 1);
+    feature.setRT(10.0 * i);
+    feature.setMZ(400.0 + i);
+    feature.setIntensity(1000.0 * i);
+    feature.setCharge(1 + i % 5);
+    feature.setOverallQuality(i / 20.0);
+    feature.setMetaValue("label", i % 2 == 0 ? "even" : "odd");
+    feature.setMetaValue("score", 0.1 * i);
+    Feature subordinate;
+    subordinate.setUniqueId(100 + i);
+    subordinate.setIntensity(i);
+    feature.getSubordinates().push_back(subordinate);
+    map.push_back(feature);
+  }
+
+  FeatureSQLFile fsf;
+  FeatureSQLFile::WriteOptions write_options;
+  write_options.index_core_columns = true;
+  write_options.indexed_meta_keys.insert("label");
+  fsf.write(filter_file, map, write_options);
+
+  FeatureSQLFile::ReadOptions options;
+  options.charge_min = 2;
+  options.charge_max = 4;
+  options.quality_min = 0.5;
+  FeatureMap output = fsf.read(filter_file, options);
+  // i in [10, 20) with i % 5 in [1, 3]
+  TEST_EQUAL(output.size(), 6)
+  for (const Feature& feature : output)
+  {
+    TEST_EQUAL(feature.getCharge() >= 2 && feature.getCharge() <= 4, true)
+    TEST_EQUAL(feature.getOverallQuality() >= 0.5, true)
+    ABORT_IF(feature.getSubordinates().size() != 1)
+    TEST_EQUAL(feature.getSubordinates()[0].getUniqueId(), 99 + feature.getUniqueId())
+  }
+
+  // meta values are compared in their typed column
+  options = FeatureSQLFile::ReadOptions();
+  options.meta_values["label"] = "odd";
+  options.intensity_max = 9000.0;
+  output = fsf.read(filter_file, options);
+  TEST_EQUAL(output.size(), 5)
+  options.meta_values.clear();
+  options.meta_values["score"] = 0.1 * 3;
+  TEST_EQUAL(fsf.read(filter_file, options).size(), 1)
+  options.meta_values["score"] = "high";
+  TEST_EQUAL(fsf.read(filter_file, options).size(), 0)
+  options.meta_values["score"] = DataValue();
+  TEST_EXCEPTION(Exception::IllegalArgument, fsf.read(filter_file, options))
+
+  // filters apply to streaming and region reads as well
+  options = FeatureSQLFile::ReadOptions();
+  options.intensity_min = 15000.0;
+  Size count = 0;
+  fsf.readStreaming(filter_file, [&count](Feature&) { ++count; }, options);
+  TEST_EQUAL(count, 5)
+  TEST_EQUAL(fsf.readRegion(filter_file, 0.0, 165.0, 0.0, 1000.0, options).size(), 2)
+}
+END_SECTION
+
+START_SECTION((Writer))
+{
+  std::string writer_file;
+  NEW_TMP_FILE(writer_file);
+  std::string writer_aborted_file;
+  NEW_TMP_FILE(writer_aborted_file);
+  FeatureSQLFile fsf;
+  std::string reference_file;
+  NEW_TMP_FILE(reference_file);
+  FeatureMap expected = writeReference(reference_file);
+  ABORT_IF(expected.empty())
+
+  // meta keys, subordinates and convex hulls show up while streaming
+  FeatureMap schema;
+  schema.setUniqueId(expected.getUniqueId());
+  schema.setDataProcessing(expected.getDataProcessing());
+  FeatureSQLFile::Writer writer;
+  TEST_EXCEPTION(Exception::IllegalArgument, writer.consume(expected[0]))
+  writer.open(writer_file, schema);
+  TEST_EXCEPTION(Exception::IllegalArgument, writer.open(writer_file, schema))
+  Feature plain;
+  plain.setUniqueId(1);
+  plain.setRT(1.0);
+  writer.consume(plain);
+  for (const Feature& feature : expected)
+  {
+    writer.consume(feature);
+  }
+  writer.close();
+  TEST_EXCEPTION(Exception::IllegalArgument, writer.close())
+
+  FeatureMap output = fsf.read(writer_file);
+  TEST_EQUAL(output.size(), expected.size() + 1)
+  TEST_EQUAL(output.getDataProcessing().size(), expected.getDataProcessing().size())
+  ABORT_IF(output.size() != expected.size() + 1)
+  map<UInt64, const Feature*> by_id;
+  for (const Feature& feature : output)
+  {
+    by_id[feature.getUniqueId()] = &feature;
+  }
+  TEST_EQUAL(by_id.count(1), 1)
+  for (const Feature& feature : expected)
+  {
+    ABORT_IF(by_id.count(feature.getUniqueId()) != 1)
+    const Feature& stored = *by_id[feature.getUniqueId()];
+    TEST_REAL_SIMILAR(stored.getRT(), feature.getRT())
+    TEST_EQUAL(stored.getSubordinates().size(), feature.getSubordinates().size())
+    TEST_EQUAL(stored.getConvexHulls().size(), feature.getConvexHulls().size())
+    vector<String> keys, stored_keys;
+    feature.getKeys(keys);
+    stored.getKeys(stored_keys);
+    TEST_EQUAL(stored_keys.size(), keys.size())
+  }
+  TEST_EQUAL(fsf.stat(writer_file).features, expected.size() + 1)
+
+  // nothing is stored without close()
+  {
+    FeatureSQLFile::Writer aborted;
+    aborted.open(writer_aborted_file);
+    aborted.consume(plain);
+  }
+  TEST_EQUAL(fsf.read(writer_aborted_file).size(), 0)
+}
+END_SECTION
+
+START_SECTION((immutable read-only mode of ReadOptions))
+{
+  FeatureSQLFile fsf;
+  std::string reference_file;
+  NEW_TMP_FILE(reference_file);
+  FeatureMap expected = writeReference(reference_file);
+  FeatureSQLFile::ReadOptions options;
+  options.immutable = true;
+  FeatureMap output = fsf.read(reference_file, options);
+  TEST_EQUAL(output.size(), expected.size())
+  TEST_EQUAL(output.getDataProcessing().size(), expected.getDataProcessing().size())
+  ABORT_IF(output.size() != expected.size())
+  for (Size i = 0; i < output.size(); ++i)
+  {
+    TEST_EQUAL(output[i].getUniqueId(), expected[i].getUniqueId())
+    TEST_EQUAL(output[i].getSubordinates().size(), expected[i].getSubordinates().size())
+  }
+
+  Size count = 0;
+  fsf.readStreaming(reference_file, [&count](Feature&) { ++count; }, options);
+  TEST_EQUAL(count, expected.size())
+  const Feature& target = expected[0];
+  TEST_EQUAL(fsf.readRegion(reference_file, target.getRT() - 1.0, target.getRT() + 1.0, target.getMZ() - 0.01, target.getMZ() + 0.01, options).empty(), false)
+
+  TEST_EXCEPTION(Exception::FileNotFound, fsf.read(OPENMS_GET_TEST_DATA_PATH("test_does_not_exist"), options))
+}
+END_SECTION
+
+START_SECTION((string_dictionary of WriteOptions))
+{
+  std::string dictionary_file;
+  NEW_TMP_FILE(dictionary_file);
+  std::string dictionary_writer_file;
+  NEW_TMP_FILE(dictionary_writer_file);
+  FeatureMap map;
+  for (Size i = 0; i < 12; ++i)
+  {
+    Feature feature;
+    feature.setUniqueId(i + 1);
+    feature.setRT(10.0 * i);
+    feature.setMZ(400.0 + i);
+    feature.setMetaValue("label", i % 3 == 0 ? "light" : "heavy");
+    feature.setMetaValue("name", "feature_" + String(i));
+    Feature subordinate;
+    subordinate.setUniqueId(100 + i);
+    subordinate.setMetaValue("model", "gauss");
+    feature.getSubordinates().push_back(subordinate);
+    map.push_back(feature);
+  }
+
+  // plain text unless requested
+  TEST_EQUAL(FeatureSQLFile::WriteOptions().string_dictionary, FeatureSQLFile::DICTIONARY_NEVER)
+
+  FeatureSQLFile fsf;
+  for (Size e = 0; e < FeatureSQLFile::SIZE_OF_DICTIONARYENCODING; ++e)
+  {
+    FeatureSQLFile::WriteOptions write_options;
+    write_options.string_dictionary = static_cast<FeatureSQLFile::DictionaryEncoding>(e);
+    fsf.write(dictionary_file, map, write_options);
+
+    // encoded columns are reported as strings and decoded transparently
+    FeatureSQLFile::Summary summary = fsf.stat(dictionary_file);
+    TEST_EQUAL(summary.feature_meta_keys["label"], DataValue::STRING_VALUE)
+    TEST_EQUAL(summary.subordinate_meta_keys["model"], DataValue::STRING_VALUE)
+    FeatureMap output = fsf.read(dictionary_file);
+    ABORT_IF(output.size() != map.size())
+    for (Size i = 0; i < output.size(); ++i)
+    {
+      TEST_EQUAL(output[i].getMetaValue("label"), map[i].getMetaValue("label"))
+      TEST_EQUAL(output[i].getMetaValue("name"), map[i].getMetaValue("name"))
+      ABORT_IF(output[i].getSubordinates().size() != 1)
+      TEST_EQUAL(output[i].getSubordinates()[0].getMetaValue("model"), "gauss")
+    }
+
+    FeatureSQLFile::ReadOptions options;
+    options.meta_values["label"] = "light";
+    TEST_EQUAL(fsf.read(dictionary_file, options).size(), 4)
+    options.meta_values["label"] = "medium";
+    TEST_EQUAL(fsf.read(dictionary_file, options).size(), 0)
+  }
+
+  // append and update keep the encoding of stored columns
+  FeatureSQLFile::WriteOptions write_options;
+  write_options.string_dictionary = FeatureSQLFile::DICTIONARY_ALWAYS;
+  fsf.write(dictionary_file, map, write_options);
+  FeatureMap more;
+  Feature added;
+  added.setUniqueId(50);
+  added.setMetaValue("label", "light");
+  added.setMetaValue("name", "added");
+  more.push_back(added);
+  fsf.append(dictionary_file, more);
+  more[0].setMetaValue("label", "medium");
+  fsf.update(dictionary_file, more);
+  FeatureSQLFile::ReadOptions options;
+  options.meta_values["label"] = "medium";
+  FeatureMap output = fsf.read(dictionary_file, options);
+  ABORT_IF(output.size() != 1)
+  TEST_EQUAL(output[0].getUniqueId(), 50)
+  TEST_EQUAL(output[0].getMetaValue("name"), "added")
+  options.meta_values["label"] = "light";
+  TEST_EQUAL(fsf.read(dictionary_file, options).size(), 4)
+
+  // the writer encodes on request
+  FeatureSQLFile::Writer writer;
+  writer.open(dictionary_writer_file, FeatureMap(), write_options);
+  for (const Feature& feature : map)
+  {
+    writer.consume(feature);
+  }
+  writer.close();
+  output = fsf.read(dictionary_writer_file);
+  ABORT_IF(output.size() != map.size())
+  TEST_EQUAL(output[1].getMetaValue("label"), "heavy")
+  TEST_EQUAL(output[1].getSubordinates()[0].getMetaValue("model"), "gauss")
+}
+END_SECTION
+
+START_SECTION((dense_meta_frequency of WriteOptions))
+{
+  std::string sparse_file;
+  NEW_TMP_FILE(sparse_file);
+  std::string sparse_writer_file;
+  NEW_TMP_FILE(sparse_writer_file);
+  FeatureMap map;
+  for (Size i = 0; i < 20; ++i)
+  {
+    Feature feature;
+    feature.setUniqueId(i + 1);
+    feature.setRT(10.0 * i);
+    feature.setMZ(400.0 + i);
+    feature.setMetaValue("score", 0.1 * i);
+    if (i == 3)
+    {
+      feature.setMetaValue("note", "rare");
+      feature.setMetaValue("flags", IntList{1, 2});
+    }
+    if (i % 10 == 0)
+    {
+      feature.setMetaValue("rank", static_cast<int>(i));
+    }
+    map.push_back(feature);
+  }
+
+  FeatureSQLFile fsf;
+  FeatureSQLFile::WriteOptions write_options;
+  write_options.dense_meta_frequency = 0.2;
+  fsf.write(sparse_file, map, write_options);
+
+  // rare keys are merged back into their features
+  FeatureMap output = fsf.read(sparse_file);
+  ABORT_IF(output.size() != map.size())
+  for (Size i = 0; i < output.size(); ++i)
+  {
+    vector<String> keys, stored_keys;
+    map[i].getKeys(keys);
+    output[i].getKeys(stored_keys);
+    TEST_EQUAL(stored_keys.size(), keys.size())
+    TEST_REAL_SIMILAR(output[i].getMetaValue("score"), map[i].getMetaValue("score"))
+  }
+  TEST_EQUAL(output[3].getMetaValue("note"), "rare")
+  TEST_EQUAL(output[3].getMetaValue("flags").toIntList().size(), 2)
+  TEST_EQUAL(int(output[10].getMetaValue("rank")), 10)
+  FeatureSQLFile::Summary summary = fsf.stat(sparse_file);
+  TEST_EQUAL(summary.feature_meta_keys.size(), 4)
+  TEST_EQUAL(summary.feature_meta_keys["note"], DataValue::STRING_VALUE)
+
+  // selected keys and filters
+  FeatureSQLFile::ReadOptions options;
+  options.all_meta_values = false;
+  options.meta_keys.insert("rank");
+  output = fsf.read(sparse_file, options);
+  TEST_EQUAL(output[3].metaValueExists("note"), false)
+  TEST_EQUAL(output[10].metaValueExists("rank"), true)
+  options = FeatureSQLFile::ReadOptions();
+  options.meta_values["note"] = "rare";
+  output = fsf.read(sparse_file, options);
+  ABORT_IF(output.size() != 1)
+  TEST_EQUAL(output[0].getUniqueId(), 4)
+  options.meta_values["note"] = 5;
+  TEST_EQUAL(fsf.read(sparse_file, options).size(), 0)
+
+  // append and update keep rare keys in the side table
+  FeatureMap more;
+  Feature added;
+  added.setUniqueId(50);
+  added.setMetaValue("note", "added");
+  more.push_back(added);
+  fsf.append(sparse_file, more);
+  more[0].setMetaValue("note", "updated");
+  more.push_back(map[3]);
+  more[1].removeMetaValue("note");
+  fsf.update(sparse_file, more);
+  output = fsf.read(sparse_file);
+  ABORT_IF(output.size() != map.size() + 1)
+  TEST_EQUAL(output[3].metaValueExists("note"), false)
+  TEST_EQUAL(output[3].getMetaValue("flags").toIntList().size(), 2)
+  TEST_EQUAL(output[20].getMetaValue("note"), "updated")
+
+  // the writer decides on the features of its schema
+  FeatureSQLFile::Writer writer;
+  writer.open(sparse_writer_file, map, write_options);
+  for (const Feature& feature : map)
+  {
+    writer.consume(feature);
+  }
+  writer.close();
+  output = fsf.read(sparse_writer_file);
+  ABORT_IF(output.size() != map.size())
+  TEST_EQUAL(output[3].getMetaValue("note"), "rare")
+  TEST_EQUAL(int(output[10].getMetaValue("rank")), 10)
+}
+END_SECTION
+
+START_SECTION((hull_points of WriteOptions))
+{
+  std::string hull_points_file;
+  NEW_TMP_FILE(hull_points_file);
+  FeatureMap map;
+  for (Size i = 0; i < 5; ++i)
+  {
+    Feature feature;
+    feature.setUniqueId(i + 1);
+    feature.setRT(100.0 + i);
+    feature.setMZ(500.0 + i);
+    ConvexHull2D::PointArrayType points;
+    for (Size p = 0; p < 8; ++p)
+    {
+      points.push_back(ConvexHull2D::PointType(feature.getRT() - 2.0 + 0.5 * p, feature.getMZ() + 0.001 * (p % 3) - 0.1234567));
+    }
+    ConvexHull2D hull;
+    hull.setHullPoints(points);
+    feature.getConvexHulls().push_back(hull);
+    Feature subordinate;
+    subordinate.setUniqueId(100 + i);
+    subordinate.getConvexHulls().push_back(hull);
+    feature.getSubordinates().push_back(subordinate);
+    map.push_back(feature);
+  }
+
+  FeatureSQLFile fsf;
+  FeatureSQLFile::WriteOptions write_options;
+  fsf.write(hull_points_file, map, write_options);
+  FeatureMap output = fsf.read(hull_points_file);
+  ABORT_IF(output.size() != map.size())
+  // boundingbox only
+  TEST_EQUAL(output[0].getConvexHulls()[0].getHullPoints().size(), 2)
+
+  write_options.hull_points = FeatureSQLFile::HULL_POINTS;
+  fsf.write(hull_points_file, map, write_options);
+  output = fsf.read(hull_points_file);
+  ABORT_IF(output.size() != map.size())
+  for (Size i = 0; i < output.size(); ++i)
+  {
+    TEST_EQUAL(output[i].getConvexHulls()[0].getHullPoints() == map[i].getConvexHulls()[0].getHullPoints(), true)
+    ABORT_IF(output[i].getSubordinates().size() != 1)
+    TEST_EQUAL(output[i].getSubordinates()[0].getConvexHulls()[0].getHullPoints() == map[i].getConvexHulls()[0].getHullPoints(), true)
+  }
+
+  // float32 differences stay close to the original points
+  write_options.hull_points = FeatureSQLFile::HULL_POINTS_FLOAT32;
+  fsf.write(hull_points_file, map, write_options);
+  output = fsf.read(hull_points_file);
+  ABORT_IF(output.size() != map.size())
+  const ConvexHull2D::PointArrayType& expected = map[4].getConvexHulls()[0].getHullPoints();
+  const ConvexHull2D::PointArrayType& stored = output[4].getConvexHulls()[0].getHullPoints();
+  ABORT_IF(stored.size() != expected.size())
+  for (Size p = 0; p < stored.size(); ++p)
+  {
+    TEST_EQUAL(fabs(stored[p][0] - expected[p][0]) < 1e-5, true)
+    TEST_EQUAL(fabs(stored[p][1] - expected[p][1]) < 1e-5, true)
+  }
+
+  // append keeps the encoding of the file
+  FeatureMap more;
+  more.push_back(map[0]);
+  more[0].setUniqueId(50);
+  fsf.append(hull_points_file, more);
+  output = fsf.read(hull_points_file);
+  ABORT_IF(output.size() != map.size() + 1)
+  TEST_EQUAL(output[5].getConvexHulls()[0].getHullPoints().size(), 8)
+}
+END_SECTION
+
+START_SECTION((FeatureMap readByIds(const std::string& in_featureSQL, const std::vector<UInt64>& ids, const ReadOptions& options = ReadOptions()) const))
+{
+  FeatureSQLFile fsf;
+  std::string reference_file;
+  NEW_TMP_FILE(reference_file);
+  FeatureMap expected = writeReference(reference_file);
+  ABORT_IF(expected.size() < 2)
+
+  // caller's order, unknown IDs are skipped and repeated IDs copied
+  vector<UInt64> ids = {expected.back().getUniqueId(), 12345, expected[0].getUniqueId(), expected.back().getUniqueId()};
+  FeatureMap output = fsf.readByIds(reference_file, ids);
+  TEST_EQUAL(output.getDataProcessing().size(), expected.getDataProcessing().size())
+  ABORT_IF(output.size() != 3)
+  TEST_EQUAL(output[0].getUniqueId(), expected.back().getUniqueId())
+  TEST_EQUAL(output[1].getUniqueId(), expected[0].getUniqueId())
+  TEST_EQUAL(output[2].getUniqueId(), expected.back().getUniqueId())
+  TEST_EQUAL(output[1].getSubordinates().size(), expected[0].getSubordinates().size())
+  TEST_EQUAL(output[1].getConvexHulls().size(), expected[0].getConvexHulls().size())
+  TEST_EQUAL(output[2].getSubordinates().size(), expected.back().getSubordinates().size())
+  TEST_REAL_SIMILAR(output[0].getRT(), expected.back().getRT())
+
+  TEST_EQUAL(fsf.readByIds(reference_file, vector<UInt64>()).size(), 0)
+  FeatureSQLFile::ReadOptions options;
+  options.immutable = true;
+  TEST_EQUAL(fsf.readByIds(reference_file, ids, options).size(), 3)
+}
+END_SECTION
+
+START_SECTION((Size writeRun(const std::string& in_featureSQL, const FeatureMap& fm) const))
+{
+  std::string runs_file;
+  NEW_TMP_FILE(runs_file);
+  std::string runs_overlap_file;
+  NEW_TMP_FILE(runs_overlap_file);
+  FeatureSQLFile fsf;
+  std::string reference_file;
+  NEW_TMP_FILE(reference_file);
+  FeatureMap expected = writeReference(reference_file);
+  ABORT_IF(expected.size() < 2)
+
+  // two runs with half of the features each
+  const vector<FeatureMap> runs = referenceRuns(expected);
+  const FeatureMap& run1 = runs[0];
+  const FeatureMap& run2 = runs[1];
+
+  Size id1 = fsf.writeRun(runs_file, run1);
+  Size id2 = fsf.writeRun(runs_file, run2);
+  TEST_NOT_EQUAL(id1, id2)
+
+  TEST_EXCEPTION(Exception::IllegalArgument, fsf.append(runs_file, run1))
+  // single-run files take no runs
+  TEST_EXCEPTION(Exception::IllegalArgument, fsf.writeRun(reference_file, run1))
+
+  // all features read as one map
+  TEST_EQUAL(fsf.read(runs_file).size(), expected.size())
+  TEST_EQUAL(fsf.stat(runs_file).features, expected.size())
+  // dataprocessing entries and their meta keys of all runs
+  FeatureSQLFile::Summary summary = fsf.stat(runs_file);
+  TEST_EQUAL(summary.dataprocessing, 2)
+  TEST_EQUAL(summary.dataprocessing_meta_keys.size(), 2)
+  TEST_EQUAL(summary.dataprocessing_meta_keys["parameter"] == DataValue::INT_VALUE, true)
+  TEST_EQUAL(summary.dataprocessing_meta_keys["parameter: a:b"] == DataValue::STRING_VALUE, true)
+
+  // runs are independent and may reuse feature IDs
+  FeatureMap rerun = run1;
+  for (Feature& feature : rerun)
+  {
+    feature.setIntensity(feature.getIntensity() + 1.0);
+  }
+  id1 = fsf.writeRun(runs_overlap_file, run1);
+  id2 = fsf.writeRun(runs_overlap_file, rerun);
+  // the stored summary is extended by the dataprocessing entries of the second run
+  TEST_EQUAL(fsf.stat(runs_overlap_file).dataprocessing, 4)
+  vector<FeatureMap> maps = fsf.readRuns(runs_overlap_file, {id1, id2});
+  ABORT_IF(maps.size() != 2 || maps[0].size() != run1.size() || maps[1].size() != run1.size())
+  for (Size idx = 0; idx != run1.size(); ++idx)
+  {
+    TEST_EQUAL(maps[0][idx].getUniqueId(), run1[idx].getUniqueId())
+    TEST_EQUAL(maps[1][idx].getUniqueId(), run1[idx].getUniqueId())
+    TEST_REAL_SIMILAR(maps[0][idx].getIntensity(), run1[idx].getIntensity())
+    TEST_REAL_SIMILAR(maps[1][idx].getIntensity(), rerun[idx].getIntensity())
+    TEST_EQUAL(maps[1][idx].getSubordinates().size(), run1[idx].getSubordinates().size())
+    TEST_EQUAL(maps[1][idx].getConvexHulls().size(), run1[idx].getConvexHulls().size())
+  }
+  // an ID yields the features of all runs storing it
+  FeatureMap by_id = fsf.readByIds(runs_overlap_file, {run1[0].getUniqueId()});
+  ABORT_IF(by_id.size() != 2)
+  TEST_REAL_SIMILAR(by_id[0].getIntensity(), run1[0].getIntensity())
+  TEST_REAL_SIMILAR(by_id[1].getIntensity(), rerun[0].getIntensity())
+  TEST_EQUAL(fsf.readColumns(runs_overlap_file).id[run1.size()], run1[0].getUniqueId())
+  // the feature to update is ambiguous
+  TEST_EXCEPTION(Exception::IllegalArgument, fsf.update(runs_overlap_file, rerun))
+  // IDs have to be unique within a run, nothing is stored
+  FeatureMap duplicates = run1;
+  duplicates.push_back(run1[0]);
+  TEST_EXCEPTION(Exception::IllegalArgument, fsf.writeRun(runs_overlap_file, duplicates))
+  TEST_EQUAL(fsf.readRunCatalog(runs_overlap_file).size(), 2)
+  TEST_EQUAL(fsf.stat(runs_overlap_file).features, 2 * run1.size())
+}
+END_SECTION
+
+START_SECTION((std::vector<RunInfo> readRunCatalog(const std::string& in_featureSQL) const))
+{
+  std::string reference_file;
+  NEW_TMP_FILE(reference_file);
+  FeatureMap expected = writeReference(reference_file);
+  std::string runs_file;
+  NEW_TMP_FILE(runs_file);
+  FeatureSQLFile fsf;
+  for (const FeatureMap& run : referenceRuns(expected))
+  {
+    fsf.writeRun(runs_file, run);
+  }
+
+  vector<FeatureSQLFile::RunInfo> runs = fsf.readRunCatalog(runs_file);
+  ABORT_IF(runs.size() != 2)
+  TEST_EQUAL(runs[0].map_id, 11)
+  TEST_EQUAL(runs[0].identifier, "run_1")
+  TEST_EQUAL(runs[0].primary_ms_run_path.size(), 1)
+  TEST_EQUAL(runs[1].identifier, "run_2")
+  ABORT_IF(runs[1].primary_ms_run_path.size() != 2)
+  TEST_EQUAL(runs[1].primary_ms_run_path[1], "run_2b.mzML")
+  TEST_EQUAL(runs[0].features + runs[1].features, expected.size())
+
+  TEST_EQUAL(fsf.readRunCatalog(reference_file).size(), 0)
+  TEST_EXCEPTION(Exception::FileNotFound, fsf.readRunCatalog(OPENMS_GET_TEST_DATA_PATH("test_does_not_exist")))
+}
+END_SECTION
+
+START_SECTION((std::vector<FeatureMap> readRuns(const std::string& in_featureSQL, const std::vector<Size>& run_ids, const ReadOptions& options = ReadOptions()) const))
+{
+  std::string runs_file;
+  NEW_TMP_FILE(runs_file);
+  FeatureSQLFile fsf;
+  std::string reference_file;
+  NEW_TMP_FILE(reference_file);
+  FeatureMap expected = writeReference(reference_file);
+  for (const FeatureMap& run : referenceRuns(expected))
+  {
+    fsf.writeRun(runs_file, run);
+  }
+  vector<FeatureSQLFile::RunInfo> runs = fsf.readRunCatalog(runs_file);
+  ABORT_IF(runs.size() != 2)
+
+  // requested order, one map per run with its metadata
+  vector<FeatureMap> maps = fsf.readRuns(runs_file, {runs[1].run_id, runs[0].run_id});
+  ABORT_IF(maps.size() != 2)
+  TEST_EQUAL(maps[0].getUniqueId(), 12)
+  TEST_EQUAL(maps[0].getIdentifier(), "run_2")
+  TEST_EQUAL(maps[0].size(), runs[1].features)
+  TEST_EQUAL(maps[0].getDataProcessing().size(), 0)
+  TEST_EQUAL(maps[1].getIdentifier(), "run_1")
+  StringList ms_run_path;
+  maps[1].getPrimaryMSRunPath(ms_run_path);
+  TEST_EQUAL(ms_run_path.size(), 1)
+  ABORT_IF(maps[1].size() != runs[0].features || maps[1].getDataProcessing().size() != 2)
+  TEST_EQUAL(int(maps[1].getDataProcessing()[1].getMetaValue("parameter")), 3)
+  TEST_EQUAL(maps[1].getDataProcessing()[0].getMetaValue("parameter: a:b"), "on")
+  TEST_EQUAL(maps[1].getDataProcessing()[1].metaValueExists("parameter: a:b"), false)
+  TEST_EQUAL(maps[1][0].getUniqueId(), expected[0].getUniqueId())
+  TEST_EQUAL(maps[1][0].getSubordinates().size(), expected[0].getSubordinates().size())
+  TEST_EQUAL(maps[1][0].getConvexHulls().size(), expected[0].getConvexHulls().size())
+  TEST_EQUAL(maps[0].back().getUniqueId(), expected.back().getUniqueId())
+
+  FeatureSQLFile::ReadOptions options;
+  options.immutable = true;
+  options.dataprocessing = false;
+  maps = fsf.readRuns(runs_file, {runs[0].run_id}, options);
+  ABORT_IF(maps.size() != 1)
+  TEST_EQUAL(maps[0].size(), runs[0].features)
+  TEST_EQUAL(maps[0].getDataProcessing().size(), 0)
+
+  TEST_EXCEPTION(Exception::IllegalArgument, fsf.readRuns(runs_file, {runs[1].run_id + 1}))
+  TEST_EXCEPTION(Exception::IllegalArgument, fsf.readRuns(reference_file, {runs[0].run_id}))
+}
+END_SECTION
+
+START_SECTION((std::vector<MZHit> searchMZ(const std::vector<std::string>& in_featureSQLs, const std::vector<double>& mzs, double ppm, double rt_min = -std::numeric_limits<double>::max(), double rt_max = std::numeric_limits<double>::max()) const))
+{
+  std::string runs_file;
+  NEW_TMP_FILE(runs_file);
+  FeatureSQLFile fsf;
+  std::string reference_file;
+  NEW_TMP_FILE(reference_file);
+  FeatureMap expected = writeReference(reference_file);
+  ABORT_IF(expected.size() < 11)
+  for (const FeatureMap& run : referenceRuns(expected))
+  {
+    fsf.writeRun(runs_file, run);
+  }
+  const vector<string> files = {reference_file, runs_file};
+
+  // repeated masses match separately, masses without feature do not match
+  vector<double> mzs = {expected[10].getMZ() + 1e-4, expected[3].getMZ(), 50.0, expected[3].getMZ()};
+  vector<FeatureSQLFile::MZHit> hits = fsf.searchMZ(files, mzs, 5.0);
+  ABORT_IF(hits.size() != 6)
+  // files in order, ascending by m/z
+  TEST_EQUAL(hits[0].file, files[0])
+  TEST_EQUAL(hits[0].query, 1)
+  TEST_EQUAL(hits[1].query, 3)
+  TEST_EQUAL(hits[0].id, expected[3].getUniqueId())
+  TEST_REAL_SIMILAR(hits[0].mz, expected[3].getMZ())
+  TEST_REAL_SIMILAR(hits[0].rt, expected[3].getRT())
+  TEST_REAL_SIMILAR(hits[0].intensity, expected[3].getIntensity())
+  TEST_EQUAL(hits[0].charge, expected[3].getCharge())
+  TEST_EQUAL(hits[2].query, 0)
+  TEST_EQUAL(hits[2].id, expected[10].getUniqueId())
+  TEST_EQUAL(hits[3].file, files[1])
+  TEST_EQUAL(hits[5].id, expected[10].getUniqueId())
+
+  // tolerance is relative to the query mass
+  TEST_EQUAL(fsf.searchMZ(files, {expected[10].getMZ() + 1e-4}, 0.1).size(), 0)
+  // RT window
+  hits = fsf.searchMZ({files[0]}, mzs, 5.0, expected[3].getRT() - 1.0, expected[3].getRT() + 1.0);
+  ABORT_IF(hits.size() != 2)
+  TEST_EQUAL(hits[0].id, expected[3].getUniqueId())
+
+  TEST_EQUAL(fsf.searchMZ(files, vector<double>(), 5.0).size(), 0)
+  TEST_EXCEPTION(Exception::IllegalArgument, fsf.searchMZ(files, mzs, -1.0))
+  TEST_EXCEPTION(Exception::FileNotFound, fsf.searchMZ({OPENMS_GET_TEST_DATA_PATH("test_does_not_exist")}, mzs, 5.0))
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST